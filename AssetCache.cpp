@@ -0,0 +1,302 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "AssetCache.h"
+#include "Utility.h"
+#include "WorkerPool.h"
+#include <chrono>
+#include <iostream>
+
+std::unordered_map<std::string, std::weak_ptr<Texture>>   AssetCache::s_textures;
+std::unordered_map<std::string, std::weak_ptr<Mix_Music>> AssetCache::s_music;
+std::unordered_map<std::string, std::weak_ptr<Mix_Chunk>> AssetCache::s_sounds;
+bool                                                       AssetCache::s_is_headless = false;
+
+TextureAtlas AssetCache::s_atlas;
+std::string  AssetCache::s_atlas_directory;
+
+std::vector<AssetCache::PendingTexture>       AssetCache::s_pending_textures;
+std::unordered_map<std::string, MusicRequest> AssetCache::s_pending_music;
+std::unordered_map<std::string, SoundRequest> AssetCache::s_pending_sounds;
+
+AssetCache::DecodedImage::~DecodedImage()
+{
+    if (m_pixels != NULL) Utility::free_image(m_pixels);
+}
+
+// Both safe to run on a worker: neither touches GL or the cache's maps
+static std::shared_ptr<Mix_Music> load_music(const std::string &filepath)
+{
+    Mix_Music *loaded = Mix_LoadMUS(filepath.c_str());
+    if (loaded == NULL) LOG("Unable to load music. Make sure the path is correct.");
+    
+    return std::shared_ptr<Mix_Music>(loaded, [](Mix_Music *music) { if (music != NULL) Mix_FreeMusic(music); });
+}
+
+static std::shared_ptr<Mix_Chunk> load_sound(const std::string &filepath)
+{
+    Mix_Chunk *loaded = Mix_LoadWAV(filepath.c_str());
+    if (loaded == NULL) LOG("Unable to load sound. Make sure the path is correct.");
+    
+    return std::shared_ptr<Mix_Chunk>(loaded, [](Mix_Chunk *sound) { if (sound != NULL) Mix_FreeChunk(sound); });
+}
+
+template <typename T>
+static std::shared_future<T> ready_future(T value)
+{
+    std::promise<T> promise;
+    promise.set_value(value);
+    return promise.get_future().share();
+}
+
+// Finished audio requests have nothing left to do on the main thread; they only move to the resident map
+template <typename T>
+static void retire_finished(std::unordered_map<std::string, std::shared_future<std::shared_ptr<T>>> &pending,
+                            std::unordered_map<std::string, std::weak_ptr<T>> &resident)
+{
+    for (auto entry = pending.begin(); entry != pending.end();)
+    {
+        if (entry->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++entry;
+            continue;
+        }
+        
+        resident[entry->first] = entry->second.get();
+        entry = pending.erase(entry);
+    }
+}
+
+std::shared_ptr<Texture> AssetCache::get_texture(const char *filepath)
+{
+    std::weak_ptr<Texture> &entry = s_textures[filepath];
+    
+    std::shared_ptr<Texture> texture = entry.lock();
+    if (texture != nullptr)
+    {
+        // Requested earlier but not uploaded yet: wait for the decode and upload it now
+        for (size_t i = 0; i < s_pending_textures.size() && !texture->m_is_ready; ++i)
+        {
+            if (s_pending_textures[i].m_texture != texture) continue;
+            
+            PendingTexture &pending = s_pending_textures[i];
+            upload(pending.m_filepath, *pending.m_image.get(), *texture);
+            s_pending_textures.erase(s_pending_textures.begin() + i);
+        }
+        return texture;
+    }
+    
+    texture = std::make_shared<Texture>(0);
+    if (!s_is_headless) upload(filepath, *decode(filepath), *texture);
+    
+    entry = texture;
+    return texture;
+}
+
+std::shared_ptr<Mix_Music> AssetCache::get_music(const char *filepath)
+{
+    std::weak_ptr<Mix_Music> &entry = s_music[filepath];
+    
+    auto pending = s_pending_music.find(filepath);
+    if (pending != s_pending_music.end())
+    {
+        std::shared_ptr<Mix_Music> music = pending->second.get();
+        s_pending_music.erase(pending);
+        entry = music;
+        return music;
+    }
+    
+    std::shared_ptr<Mix_Music> music = entry.lock();
+    if (music != nullptr) return music;
+    if (s_is_headless)    return nullptr;
+    
+    music = load_music(filepath);
+    entry = music;
+    return music;
+}
+
+std::shared_ptr<Mix_Chunk> AssetCache::get_sound(const char *filepath)
+{
+    std::weak_ptr<Mix_Chunk> &entry = s_sounds[filepath];
+    
+    auto pending = s_pending_sounds.find(filepath);
+    if (pending != s_pending_sounds.end())
+    {
+        std::shared_ptr<Mix_Chunk> sound = pending->second.get();
+        s_pending_sounds.erase(pending);
+        entry = sound;
+        return sound;
+    }
+    
+    std::shared_ptr<Mix_Chunk> sound = entry.lock();
+    if (sound != nullptr) return sound;
+    if (s_is_headless)    return nullptr;
+    
+    sound = load_sound(filepath);
+    entry = sound;
+    return sound;
+}
+
+std::shared_ptr<Texture> AssetCache::request_texture(const char *filepath)
+{
+    std::weak_ptr<Texture> &entry = s_textures[filepath];
+    
+    std::shared_ptr<Texture> texture = entry.lock();
+    if (texture != nullptr) return texture;
+    
+    texture = std::make_shared<Texture>(0);
+    entry = texture;
+    if (s_is_headless) return texture;
+    
+    texture->m_is_ready = false;
+    
+    auto load = std::make_shared<std::packaged_task<std::shared_ptr<DecodedImage>()>>([path = std::string(filepath)]() {
+        return decode(path);
+    });
+    
+    s_pending_textures.push_back(PendingTexture { filepath, texture, load->get_future() });
+    WorkerPool::get_shared().submit([load]() { (*load)(); });
+    
+    return texture;
+}
+
+MusicRequest AssetCache::request_music(const char *filepath)
+{
+    auto pending = s_pending_music.find(filepath);
+    if (pending != s_pending_music.end()) return pending->second;
+    
+    std::shared_ptr<Mix_Music> music = s_music[filepath].lock();
+    if (music != nullptr || s_is_headless) return ready_future(music);
+    
+    auto load = std::make_shared<std::packaged_task<std::shared_ptr<Mix_Music>()>>([path = std::string(filepath)]() {
+        return load_music(path);
+    });
+    
+    MusicRequest request = load->get_future().share();
+    s_pending_music[filepath] = request;
+    WorkerPool::get_shared().submit([load]() { (*load)(); });
+    
+    return request;
+}
+
+SoundRequest AssetCache::request_sound(const char *filepath)
+{
+    auto pending = s_pending_sounds.find(filepath);
+    if (pending != s_pending_sounds.end()) return pending->second;
+    
+    std::shared_ptr<Mix_Chunk> sound = s_sounds[filepath].lock();
+    if (sound != nullptr || s_is_headless) return ready_future(sound);
+    
+    auto load = std::make_shared<std::packaged_task<std::shared_ptr<Mix_Chunk>()>>([path = std::string(filepath)]() {
+        return load_sound(path);
+    });
+    
+    SoundRequest request = load->get_future().share();
+    s_pending_sounds[filepath] = request;
+    WorkerPool::get_shared().submit([load]() { (*load)(); });
+    
+    return request;
+}
+
+bool AssetCache::load_atlas(const char *manifest_filepath)
+{
+    if (!s_atlas.load(manifest_filepath)) return false;
+    
+    std::string filepath = manifest_filepath;
+    size_t separator = filepath.find_last_of('/');
+    s_atlas_directory = separator == std::string::npos ? "" : filepath.substr(0, separator + 1);
+    
+    return true;
+}
+
+SpriteSheet AssetCache::find_sheet(const char *filepath, std::shared_ptr<Texture> (*load)(const char *))
+{
+    std::string name = filepath;
+    size_t separator = name.find_last_of('/');
+    if (separator != std::string::npos) name = name.substr(separator + 1);
+    
+    const AtlasRegion *region = s_atlas.find(name);
+    if (region == NULL) return SpriteSheet { load(filepath), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f) };
+    
+    // Pages are cached by path like any other texture, so every sheet on a page shares one GL texture
+    std::string page_filepath = s_atlas_directory + s_atlas.get_page(region->m_page).m_filename;
+    return SpriteSheet { load(page_filepath.c_str()), s_atlas.get_uv(*region) };
+}
+
+SpriteSheet AssetCache::get_sheet(const char *filepath)
+{
+    return find_sheet(filepath, get_texture);
+}
+
+SpriteSheet AssetCache::request_sheet(const char *filepath)
+{
+    return find_sheet(filepath, request_texture);
+}
+
+std::shared_ptr<AssetCache::DecodedImage> AssetCache::decode(const std::string &filepath)
+{
+    std::shared_ptr<DecodedImage> image = std::make_shared<DecodedImage>();
+    
+    // A baked texture only needs its pages read in, and that happens here rather than during the upload
+    image->m_baked = TextureFile::open(TextureFile::baked_path(filepath.c_str()).c_str());
+    if (image->m_baked != nullptr) image->m_baked->prefetch();
+    else                           image->m_pixels = Utility::decode_image(filepath.c_str(), &image->m_width, &image->m_height);
+    
+    return image;
+}
+
+void AssetCache::upload(const std::string &filepath, const DecodedImage &image, Texture &texture)
+{
+    if (image.m_baked != nullptr)
+    {
+        texture.m_id = Utility::upload_texture(*image.m_baked);
+    }
+    else if (image.m_pixels == NULL)
+    {
+        LOG("Unable to load image " << filepath << ". Make sure the path is correct.");
+        texture.m_has_failed = true;
+    }
+    else
+    {
+        texture.m_id = Utility::upload_texture(image.m_pixels, image.m_width, image.m_height);
+    }
+    
+    texture.m_is_ready = true;
+}
+
+int AssetCache::process_uploads(double budget_ms)
+{
+    retire_finished(s_pending_music,  s_music);
+    retire_finished(s_pending_sounds, s_sounds);
+    
+    auto start = std::chrono::steady_clock::now();
+    bool has_uploaded = false;
+    
+    for (size_t i = 0; i < s_pending_textures.size();)
+    {
+        if (has_uploaded && std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() >= budget_ms) break;
+        
+        if (s_pending_textures[i].m_image.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+        {
+            ++i;
+            continue;
+        }
+        
+        PendingTexture &pending = s_pending_textures[i];
+        upload(pending.m_filepath, *pending.m_image.get(), *pending.m_texture);
+        s_pending_textures.erase(s_pending_textures.begin() + i);
+        has_uploaded = true;
+    }
+    
+    return (int) (s_pending_textures.size() + s_pending_music.size() + s_pending_sounds.size());
+}
+
+int const AssetCache::get_resident_count()
+{
+    int count = 0;
+    
+    for (auto &entry : s_textures) if (!entry.second.expired()) ++count;
+    for (auto &entry : s_music)    if (!entry.second.expired()) ++count;
+    for (auto &entry : s_sounds)   if (!entry.second.expired()) ++count;
+    
+    return count;
+}
@@ -0,0 +1,126 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <SDL_mixer.h>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "TextureAtlas.h"
+#include "TextureFile.h"
+
+/**
+    A GL texture that is deleted when the last reference to it goes away. A texture requested asynchronously
+    exists before its pixels do: m_id stays 0 and m_is_ready false until the main thread has uploaded it.
+    
+    An image that can't be decoded still ends up ready, but with m_has_failed set and m_id left at 0. There is
+    nothing to draw, and whatever draws with id 0 skips it.
+*/
+struct Texture
+{
+    GLuint m_id;
+    bool   m_is_ready;
+    bool   m_has_failed;
+    
+    Texture(GLuint id) : m_id(id), m_is_ready(true), m_has_failed(false) {}
+    ~Texture() { if (m_id != 0) glDeleteTextures(1, &m_id); }
+    
+    Texture(const Texture &) = delete;
+    Texture &operator=(const Texture &) = delete;
+};
+
+/**
+    A sprite or tile sheet as it was asked for by file path: either its own texture, with m_region covering all
+    of it, or the atlas page it was packed into, with m_region the sheet's part of the page (u, v, width, height).
+*/
+struct SpriteSheet
+{
+    std::shared_ptr<Texture> m_texture;
+    glm::vec4                m_region;
+};
+
+typedef std::shared_future<std::shared_ptr<Mix_Music>> MusicRequest;
+typedef std::shared_future<std::shared_ptr<Mix_Chunk>> SoundRequest;
+
+/**
+    Hands out shared, reference-counted assets keyed by file path. An asset is decoded the first time it is
+    asked for and stays resident for as long as anyone holds a reference; the last holder to let go frees it.
+    Re-initialising a scene therefore reuses everything it already holds instead of loading it again.
+    
+    The request_* calls return at once and decode on the shared WorkerPool. Decoded images wait for
+    process_uploads on the main thread; a get_* for something still in flight finishes it on the spot.
+    All of this class is main-thread only; the workers only ever see their own decode job.
+*/
+class AssetCache {
+private:
+    // Either the baked file, mapped and paged in, or the PNG decoded to RGBA8
+    struct DecodedImage
+    {
+        std::shared_ptr<TextureFile> m_baked;
+        unsigned char               *m_pixels = NULL;
+        int                          m_width  = 0;
+        int                          m_height = 0;
+        
+        ~DecodedImage();
+    };
+    
+    struct PendingTexture
+    {
+        std::string                                m_filepath;
+        std::shared_ptr<Texture>                   m_texture;
+        std::future<std::shared_ptr<DecodedImage>> m_image;
+    };
+    
+    static std::vector<PendingTexture>                    s_pending_textures;
+    static std::unordered_map<std::string, MusicRequest>  s_pending_music;
+    static std::unordered_map<std::string, SoundRequest>  s_pending_sounds;
+    
+    // decode is safe to run on a worker; upload fills in texture on the main thread, or marks it failed
+    static std::shared_ptr<DecodedImage> decode(const std::string &filepath);
+    static void                          upload(const std::string &filepath, const DecodedImage &image, Texture &texture);
+
+    static std::unordered_map<std::string, std::weak_ptr<Texture>>   s_textures;
+    static std::unordered_map<std::string, std::weak_ptr<Mix_Music>> s_music;
+    static std::unordered_map<std::string, std::weak_ptr<Mix_Chunk>> s_sounds;
+    static bool                                                       s_is_headless;
+    
+    static TextureAtlas s_atlas;
+    static std::string  s_atlas_directory;
+    
+    static SpriteSheet find_sheet(const char *filepath, std::shared_ptr<Texture> (*load)(const char *));
+    
+public:
+    // ————— METHODS ————— //
+    static std::shared_ptr<Texture>   get_texture(const char *filepath);
+    static std::shared_ptr<Mix_Music> get_music(const char *filepath);
+    static std::shared_ptr<Mix_Chunk> get_sound(const char *filepath);
+    
+    static std::shared_ptr<Texture> request_texture(const char *filepath);
+    static MusicRequest             request_music(const char *filepath);
+    static SoundRequest             request_sound(const char *filepath);
+    
+    // Sheets named in the loaded atlas manifest come back as their page plus a region; any other sheet (or
+    // every sheet, if no manifest was loaded) comes back as its own texture
+    static bool        load_atlas(const char *manifest_filepath);
+    static SpriteSheet get_sheet(const char *filepath);
+    static SpriteSheet request_sheet(const char *filepath);
+    
+    // Uploads decoded textures until budget_ms has gone by (at least one per call, so loading always moves).
+    // Returns how many requests of any kind are still in flight.
+    static int process_uploads(double budget_ms);
+    
+    // Headless runs have no GL context or audio device: textures come back as id 0 without being decoded,
+    // and music and sounds come back empty
+    static void set_headless(bool is_headless) { s_is_headless = is_headless; }
+    
+    static int const get_resident_count();
+};
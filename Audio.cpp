@@ -0,0 +1,36 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "Audio.h"
+#include <iostream>
+
+bool Audio::s_is_open = false;
+
+bool Audio::open()
+{
+    // The audio device is opened once for the whole run; scenes only load and play their clips
+    s_is_open = Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096) == 0;
+    if (!s_is_open) LOG("Unable to open the audio device; continuing without sound.");
+    
+    return s_is_open;
+}
+
+void Audio::close()
+{
+    if (s_is_open) Mix_CloseAudio();
+    s_is_open = false;
+}
+
+void Audio::play_music(Mix_Music *music, int loops)
+{
+    if (s_is_open && music != NULL) Mix_PlayMusic(music, loops);
+}
+
+void Audio::set_music_volume(int volume)
+{
+    if (s_is_open) Mix_VolumeMusic(volume);
+}
+
+void Audio::play_sound(Mix_Chunk *sound)
+{
+    if (s_is_open && sound != NULL) Mix_PlayChannel(-1, sound, 0);
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <SDL_mixer.h>
+
+/**
+    The only place the game talks to SDL_mixer for playback. Until open() succeeds every call is a no-op,
+    which is all the null backend a headless run needs.
+*/
+class Audio {
+private:
+    static bool s_is_open;
+    
+public:
+    // ————— METHODS ————— //
+    static bool open();
+    static void close();
+    
+    static void play_music(Mix_Music *music, int loops);
+    static void set_music_volume(int volume);
+    static void play_sound(Mix_Chunk *sound);
+    
+    // ————— GETTERS ————— //
+    static bool const is_open() { return s_is_open; }
+};
@@ -1,6 +1,6 @@
 #include "Effects.h"
 
-Effects::Effects(glm::mat4 projection_matrix, glm::mat4 view_matrix)
+Effects::Effects(glm::mat4 projection_matrix, glm::mat4 view_matrix, unsigned int seed) : m_random(seed)
 {
     // Non textured Shader
     m_program.Load("shaders/vertex.glsl", "shaders/fragment.glsl");
@@ -17,7 +17,9 @@ Effects::Effects(glm::mat4 projection_matrix, glm::mat4 view_matrix)
 
 void Effects::draw_overlay()
 {
-    glUseProgram(this->m_program.programID);
+    GLStatsScope scope(SUBSYSTEM_EFFECTS);
+    
+    GLStats::use_program(this->m_program.programID);
 
     float vertices[] =
     {
@@ -31,9 +33,9 @@ void Effects::draw_overlay()
     };
 
     glVertexAttribPointer(m_program.positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(m_program.positionAttribute);
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    glDisableVertexAttribArray(m_program.positionAttribute);
+    GLStats::enable_attribute(m_program.positionAttribute);
+    GLStats::draw_arrays(GL_TRIANGLES, 0, 6);
+    GLStats::disable_attribute(m_program.positionAttribute);
 }
 
 void Effects::start(EffectType effect_type, float effect_speed)
@@ -89,7 +91,9 @@ void Effects::update(float delta_time)
            {
                float min = -0.1f;
                float max =  0.0f;
-               float offset_value = ((float) rand() / RAND_MAX) * (max - min) + min;
+               // minstd_rand's sequence is fixed by the standard, unlike the distributions, so scale it by hand
+               float unit         = (float) (m_random() - m_random.min()) / (m_random.max() - m_random.min());
+               float offset_value = unit * (max - min) + min;
                
                m_view_offset = glm::vec3(offset_value, offset_value, 0.0f);
            }
@@ -7,12 +7,14 @@
 
 #define GL_GLEXT_PROTOTYPES 1
 #include <vector>
+#include <random>
 #include <math.h>
 #include <SDL.h>
 #include <SDL_opengl.h>
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "GLStats.h"
 
 enum EffectType { NONE, FADEIN, FADEOUT, GROW, SHRINK, SHAKE };
 
@@ -25,11 +27,13 @@ private:
     float m_effect_speed;
     float m_size;
     float m_time_left;
+    
+    std::minstd_rand m_random; // Seeded per run, so a replay shakes exactly like the recording did
 
 public:
     glm::vec3 m_view_offset;
     
-    Effects(glm::mat4 projection_matrix, glm::mat4 view_matrix);
+    Effects(glm::mat4 projection_matrix, glm::mat4 view_matrix, unsigned int seed);
 
     void draw_overlay();
     void start(EffectType effect_type, float effect_speed);
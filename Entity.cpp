@@ -1,28 +1,21 @@
-#define GL_SILENCE_DEPRECATION
-
-#ifdef _WINDOWS
-#include <GL/glew.h>
-#endif
-
 #define LOG(argument) std::cout << argument << '\n'
-#define GL_GLEXT_PROTOTYPES 1
-#include <SDL.h>
-#include <SDL_opengl.h>
-#include "glm/mat4x4.hpp"
-#include "glm/gtc/matrix_transform.hpp"
-#include "ShaderProgram.h"
+
 #include "Entity.h"
+#include "SpatialHash.h"
 
 Entity::Entity()
 {
-    m_position     = glm::vec3(0.0f);
-    m_velocity     = glm::vec3(0.0f);
-    m_acceleration = glm::vec3(0.0f);
-    
-    m_movement = glm::vec3(0.0f);
-    
-    m_speed = 0;
-    m_model_matrix = glm::mat4(1.0f);
+}
+
+Entity::Entity(EntityPool *pool)
+{
+    bind(pool);
+}
+
+void Entity::bind(EntityPool *pool)
+{
+    m_pool = pool;
+    m_slot = pool->allocate();
 }
 
 Entity::~Entity()
@@ -34,8 +27,69 @@ Entity::~Entity()
     delete [] m_walking;
 }
 
-void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index)
+void Entity::spawn(const LevelSpawn &spawn)
+{
+    m_entity_type = (EntityType) spawn.entity_type;
+    m_ai_type     = (AIType)     spawn.ai_type;
+    m_ai_state    = (AIState)    spawn.ai_state;
+    
+    set_position(glm::vec3(spawn.x, spawn.y, 0.0f));
+    set_movement(glm::vec3(0.0f));
+    set_speed(spawn.speed);
+    set_acceleration(glm::vec3(spawn.acceleration_x, spawn.acceleration_y, 0.0f));
+    m_jumping_power = spawn.jumping_power;
+}
+
+EntitySnapshot const Entity::capture() const
 {
+    EntitySnapshot snapshot;
+    snapshot.is_active         = get_is_active();
+    snapshot.ai_state          = m_ai_state;
+    snapshot.position          = get_position();
+    snapshot.velocity          = get_velocity();
+    snapshot.acceleration      = get_acceleration();
+    snapshot.movement          = get_movement();
+    snapshot.speed             = get_speed();
+    snapshot.animation_indices = m_animation_indices;
+    snapshot.animation_index   = m_animation_index;
+    snapshot.animation_time    = m_animation_time;
+    snapshot.is_jumping        = m_is_jumping;
+    snapshot.jumping_power     = m_jumping_power;
+    
+    return snapshot;
+}
+
+void Entity::restore(const EntitySnapshot &snapshot)
+{
+    if (snapshot.is_active) activate();
+    else                    deactivate();
+    
+    m_ai_state          = snapshot.ai_state;
+    set_position(snapshot.position);
+    set_velocity(snapshot.velocity);
+    set_acceleration(snapshot.acceleration);
+    set_movement(snapshot.movement);
+    set_speed(snapshot.speed);
+    m_animation_indices = snapshot.animation_indices;
+    m_animation_index   = snapshot.animation_index;
+    m_animation_time    = snapshot.animation_time;
+    m_is_jumping        = snapshot.is_jumping;
+    m_jumping_power     = snapshot.jumping_power;
+    
+    m_collided_top    = false;
+    m_collided_bottom = false;
+    m_collided_left   = false;
+    m_collided_right  = false;
+    m_was_on_ground   = false;
+}
+
+glm::vec4 const Entity::get_sprite_uv() const
+{
+    // Un-animated entities use their whole sheet
+    if (m_animation_indices == NULL) return m_sprite_region;
+    
+    int index = m_animation_indices[m_animation_index];
+    
     // Step 1: Calculate the UV location of the indexed frame
     float u_coord = (float) (index % m_animation_cols) / (float) m_animation_cols;
     float v_coord = (float) (index / m_animation_cols) / (float) m_animation_rows;
@@ -44,32 +98,9 @@ void Entity::draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint textu
     float width = 1.0f / (float) m_animation_cols;
     float height = 1.0f / (float) m_animation_rows;
     
-    // Step 3: Just as we have done before, match the texture coordinates to the vertices
-    float tex_coords[] =
-    {
-        u_coord, v_coord + height, u_coord + width, v_coord + height, u_coord + width, v_coord,
-        u_coord, v_coord + height, u_coord + width, v_coord, u_coord, v_coord
-    };
-    
-    float vertices[] =
-    {
-        -0.5, -0.5, 0.5, -0.5,  0.5, 0.5,
-        -0.5, -0.5, 0.5,  0.5, -0.5, 0.5
-    };
-    
-    // Step 4: And render
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->positionAttribute);
-    
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->texCoordAttribute);
-    
-    glDrawArrays(GL_TRIANGLES, 0, 6);
-    
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    // Step 3: Map the frame from the sheet into its region of the texture
+    return glm::vec4(m_sprite_region.x + u_coord * m_sprite_region.z, m_sprite_region.y + v_coord * m_sprite_region.w,
+                     width * m_sprite_region.z, height * m_sprite_region.w);
 }
 
 void Entity::ai_activate(Entity *player)
@@ -103,10 +134,10 @@ void Entity::ai_jumper(Entity *player)
 
 void Entity::ai_walker(Entity *player)
 {
-    if (m_position.x > player->get_position().x) {
-        m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+    if (position_x() > player->get_position().x) {
+        set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
     } else {
-        m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
+        set_movement(glm::vec3(1.0f, 0.0f, 0.0f));
     }
     
 }
@@ -115,14 +146,14 @@ void Entity::ai_guard(Entity *player)
 {
     switch (m_ai_state) {
         case IDLE:
-            if (glm::distance(m_position, player->get_position()) < 3.0f) m_ai_state = WALKING;
+            if (glm::distance(get_position(), player->get_position()) < 3.0f) m_ai_state = WALKING;
             break;
             
         case WALKING:
-            if (m_position.x > player->get_position().x) {
-                m_movement = glm::vec3(-1.0f, 0.0f, 0.0f);
+            if (position_x() > player->get_position().x) {
+                set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
             } else {
-                m_movement = glm::vec3(1.0f, 0.0f, 0.0f);
+                set_movement(glm::vec3(1.0f, 0.0f, 0.0f));
             }
             break;
             
@@ -134,20 +165,24 @@ void Entity::ai_guard(Entity *player)
     }
 }
 
-void Entity::update(float delta_time, Entity *player, Entity *objects, int object_count, Map *map)
+void Entity::begin_step(float delta_time, Entity *player)
 {
-    if (!m_is_active) return;
+    if (!get_is_active()) return;
+    
+    // AI reacts to how the last step ended (e.g. jumpers only jump off the ground), so run it before the reset
+    if (m_entity_type == ENEMY) ai_activate(player);
+    
+    m_was_on_ground = m_collided_bottom;
+    m_step_origin   = get_position();
  
     m_collided_top    = false;
     m_collided_bottom = false;
     m_collided_left   = false;
     m_collided_right  = false;
     
-    if (m_entity_type == ENEMY) ai_activate(player);
-    
     if (m_animation_indices != NULL)
     {
-        if (glm::length(m_movement) != 0)
+        if (glm::length(get_movement()) != 0)
         {
             m_animation_time += delta_time;
             float frames_per_second = (float) 1 / SECONDS_PER_FRAME;
@@ -164,47 +199,43 @@ void Entity::update(float delta_time, Entity *player, Entity *objects, int objec
             }
         }
     }
+}
+
+void Entity::resolve_y(TileGrid *map, SpatialHash *spatial_hash, std::vector<CollisionEvent> *events)
+{
+    if (!get_is_active()) return;
     
-    // Our character moves from left to right, so they need an initial velocity
-    m_velocity.x = m_movement.x * m_speed;
-    
-    // Now we add the rest of the gravity physics
-    m_velocity += m_acceleration * delta_time;
+    // Collisions are reported, not acted on; whoever owns the event buffer decides what they mean
+    Entity *collided_entity = check_collision_y(spatial_hash);
     
-    m_position.y += m_velocity.y * delta_time;
-    check_collision_y(objects, object_count);
+    if (m_collided_bottom == true) {
+        events->push_back(CollisionEvent { STOMP, this, collided_entity });
+    }
+    else if (m_collided_top == true) {
+        events->push_back(CollisionEvent { HIT, this, collided_entity });
+    }
     
-//    if (m_entity_type == PLAYER && objects->m_entity_type == ENEMY) {
-        if (m_collided_bottom == true) {
-            LOG("WAAOOOOOHHH");
-            objects->deactivate();
-        }
-        else if (m_collided_top == true) {
-            LOG("YURRRRRRRRRR2222");
-            player->deactivate();
-        }
-//    }
-    
-//    if (m_entity_type == ENEMY && objects->m_entity_type == PLAYER) {
-//        LOG("OKKKKKKKKKKKKKKK");
-//        if (m_collided_bottom == true) {
-//            LOG("HELOOOOOOOOOOOOOO");
-////            objects->set_death_count(++(objects->m_death_count));
-//            objects->deactivate();
-//        }
-//    }
     check_collision_y(map);
+}
+
+void Entity::resolve_x(TileGrid *map, SpatialHash *spatial_hash, std::vector<CollisionEvent> *events)
+{
+    if (!get_is_active()) return;
     
-    m_position.x += m_velocity.x * delta_time;
-    check_collision_x(objects, object_count);
-    
+    Entity *collided_entity = check_collision_x(spatial_hash);
 
     if (m_collided_left == true || m_collided_right == true) {
-        LOG("YURRRRRRRRRR");
-        player->deactivate();
+        events->push_back(CollisionEvent { HIT, this, collided_entity });
     }
     
     check_collision_x(map);
+}
+
+void Entity::end_step(std::vector<CollisionEvent> *events)
+{
+    if (!get_is_active()) return;
+    
+    if (m_collided_bottom && !m_was_on_ground) events->push_back(CollisionEvent { LANDED, this, NULL });
     
     // Jump
     if (m_is_jumping)
@@ -213,165 +244,121 @@ void Entity::update(float delta_time, Entity *player, Entity *objects, int objec
         m_is_jumping = false;
         
         // STEP 2: The player now acquires an upward velocity
-        m_velocity.y += m_jumping_power;
+        velocity_y() += m_jumping_power;
     }
-    
-    
-    m_model_matrix = glm::mat4(1.0f);
-    m_model_matrix = glm::translate(m_model_matrix, m_position);
 }
 
-void const Entity::check_collision_y(Entity *collidable_entities, int collidable_entity_count)
+bool Entity::resolve_collision_y(Entity *collidable_entity)
 {
-    for (int i = 0; i < collidable_entity_count; i++)
-    {
-        Entity *collidable_entity = &collidable_entities[i];
+    if (!check_collision(collidable_entity)) return false;
+    
+    float y_distance = fabs(position_y() - collidable_entity->get_position().y);
+    float y_overlap = fabs(y_distance - (height() / 2.0f) - (collidable_entity->get_height() / 2.0f));
+    if (velocity_y() > 0) {
+        position_y()   -= y_overlap;
+        velocity_y()    = 0;
+        m_collided_top  = true;
+    } else if (velocity_y() < 0) {
+        position_y()      += y_overlap;
+        velocity_y()       = 0;
+        m_collided_bottom  = true;
         
-        if (check_collision(collidable_entity))
-        {
-            float y_distance = fabs(m_position.y - collidable_entity->get_position().y);
-            float y_overlap = fabs(y_distance - (m_height / 2.0f) - (collidable_entity->m_height / 2.0f));
-            if (m_velocity.y > 0) {
-                m_position.y   -= y_overlap;
-                m_velocity.y    = 0;
-                m_collided_top  = true;
-            } else if (m_velocity.y < 0) {
-                m_position.y      += y_overlap;
-                m_velocity.y       = 0;
-                m_collided_bottom  = true;
-                
 //                if (m_ai_type == JUMPER && collidable_entity->get_entity_type() == PLATFORM) ai_jumper();
-            }
-        }
     }
+    
+    return true;
 }
 
-void const Entity::check_collision_x(Entity *collidable_entities, int collidable_entity_count)
+bool Entity::resolve_collision_x(Entity *collidable_entity)
 {
-    for (int i = 0; i < collidable_entity_count; i++)
-    {
-        Entity *collidable_entity = &collidable_entities[i];
-        
-        if (check_collision(collidable_entity))
-        {
-            float x_distance = fabs(m_position.x - collidable_entity->get_position().x);
-            float x_overlap = fabs(x_distance - (m_width / 2.0f) - (collidable_entity->get_width() / 2.0f));
-            if (m_velocity.x > 0) {
-                m_position.x     -= x_overlap;
-                m_velocity.x      = 0;
-                m_collided_right  = true;
-            } else if (m_velocity.x < 0) {
-                m_position.x    += x_overlap;
-                m_velocity.x     = 0;
-                m_collided_left  = true;
-            }
-        }
+    if (!check_collision(collidable_entity)) return false;
+    
+    float x_distance = fabs(position_x() - collidable_entity->get_position().x);
+    float x_overlap = fabs(x_distance - (width() / 2.0f) - (collidable_entity->get_width() / 2.0f));
+    if (velocity_x() > 0) {
+        position_x()     -= x_overlap;
+        velocity_x()      = 0;
+        m_collided_right  = true;
+    } else if (velocity_x() < 0) {
+        position_x()    += x_overlap;
+        velocity_x()     = 0;
+        m_collided_left  = true;
     }
+    
+    return true;
 }
 
-void const Entity::check_collision_y(Map *map)
+void const Entity::check_collision_y(Entity *collidable_entities, int collidable_entity_count)
 {
-    // Probes for tiles
-    glm::vec3 top = glm::vec3(m_position.x, m_position.y + (m_height / 2), m_position.z);
-    glm::vec3 top_left = glm::vec3(m_position.x - (m_width / 2), m_position.y + (m_height / 2), m_position.z);
-    glm::vec3 top_right = glm::vec3(m_position.x + (m_width / 2), m_position.y + (m_height / 2), m_position.z);
-    
-    glm::vec3 bottom = glm::vec3(m_position.x, m_position.y - (m_height / 2), m_position.z);
-    glm::vec3 bottom_left = glm::vec3(m_position.x - (m_width / 2), m_position.y - (m_height / 2), m_position.z);
-    glm::vec3 bottom_right = glm::vec3(m_position.x + (m_width / 2), m_position.y - (m_height / 2), m_position.z);
-    
-    float penetration_x = 0;
-    float penetration_y = 0;
+    for (int i = 0; i < collidable_entity_count; i++) resolve_collision_y(&collidable_entities[i]);
+}
+
+void const Entity::check_collision_x(Entity *collidable_entities, int collidable_entity_count)
+{
+    for (int i = 0; i < collidable_entity_count; i++) resolve_collision_x(&collidable_entities[i]);
+}
+
+Entity *Entity::check_collision_y(SpatialHash *spatial_hash)
+{
+    Entity *collided_entity = NULL;
     
-    if (map->is_solid(top, &penetration_x, &penetration_y) && m_velocity.y > 0)
+    // The broadphase already narrowed this to boxes that overlap; resolving still re-checks, since each push
+    // moves this entity
+    const std::vector<Entity*> &overlaps = spatial_hash->query_overlaps(this);
+    for (Entity *candidate : overlaps)
     {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
-    }
-    else if (map->is_solid(top_left, &penetration_x, &penetration_y) && m_velocity.y > 0)
-    {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
-    }
-    else if (map->is_solid(top_right, &penetration_x, &penetration_y) && m_velocity.y > 0)
-    {
-        m_position.y -= penetration_y;
-        m_velocity.y = 0;
-        m_collided_top = true;
+        // Players only collide with enemies and vice versa, just like the per-scene object lists did
+        if (candidate->m_entity_type == m_entity_type) continue;
+        if (resolve_collision_y(candidate)) collided_entity = candidate;
     }
     
-    if (map->is_solid(bottom, &penetration_x, &penetration_y) && m_velocity.y < 0)
-    {
-        m_position.y += penetration_y;
-        m_velocity.y = 0;
-        m_collided_bottom = true;
-    }
-    else if (map->is_solid(bottom_left, &penetration_x, &penetration_y) && m_velocity.y < 0)
-    {
-        m_position.y += penetration_y;
-        m_velocity.y = 0;
-        m_collided_bottom = true;
-    }
-    else if (map->is_solid(bottom_right, &penetration_x, &penetration_y) && m_velocity.y < 0)
-    {
-        m_position.y += penetration_y;
-        m_velocity.y = 0;
-        m_collided_bottom = true;
-        
-    }
+    return collided_entity;
 }
 
-void const Entity::check_collision_x(Map *map)
+Entity *Entity::check_collision_x(SpatialHash *spatial_hash)
 {
-    // Probes for tiles
-    glm::vec3 left = glm::vec3(m_position.x - (m_width / 2), m_position.y, m_position.z);
-    glm::vec3 right = glm::vec3(m_position.x + (m_width / 2), m_position.y, m_position.z);
+    Entity *collided_entity = NULL;
     
-    float penetration_x = 0;
-    float penetration_y = 0;
-    
-    if (map->is_solid(left, &penetration_x, &penetration_y) && m_velocity.x < 0)
+    const std::vector<Entity*> &overlaps = spatial_hash->query_overlaps(this);
+    for (Entity *candidate : overlaps)
     {
-        m_position.x += penetration_x;
-        m_velocity.x = 0;
-        m_collided_left = true;
-}
-    if (map->is_solid(right, &penetration_x, &penetration_y) && m_velocity.x > 0)
-    {
-        m_position.x -= penetration_x;
-        m_velocity.x = 0;
-        m_collided_right = true;
+        if (candidate->m_entity_type == m_entity_type) continue;
+        if (resolve_collision_x(candidate)) collided_entity = candidate;
     }
+    
+    return collided_entity;
 }
 
-void Entity::render(ShaderProgram *program)
+void const Entity::check_collision_y(TileGrid *map)
 {
-    if (!m_is_active) return;
+    // Sweep the whole of this step's vertical move, so a fast fall can't skip over a one-tile floor
+    glm::vec3 origin       = glm::vec3(m_step_origin.x, m_step_origin.y, 0.0f);
+    glm::vec3 displacement = glm::vec3(0.0f, position_y() - m_step_origin.y, 0.0f);
     
-    program->SetModelMatrix(m_model_matrix);
+    TileHit hit;
+    if (!map->sweep(origin, width(), height(), displacement, &hit)) return;
     
-    if (m_animation_indices != NULL)
-    {
-        draw_sprite_from_texture_atlas(program, m_texture_id, m_animation_indices[m_animation_index]);
-        return;
-    }
-    
-    float vertices[]   = { -0.5, -0.5, 0.5, -0.5, 0.5, 0.5, -0.5, -0.5, 0.5, 0.5, -0.5, 0.5 };
-    float tex_coords[] = {  0.0,  1.0, 1.0,  1.0, 1.0, 0.0,  0.0,  1.0, 1.0, 0.0,  0.0, 0.0 };
+    position_y() = origin.y + displacement.y * hit.time;
+    velocity_y() = 0;
     
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    if (hit.normal.y > 0.0f) m_collided_bottom = true;
+    else                     m_collided_top    = true;
+}
+
+void const Entity::check_collision_x(TileGrid *map)
+{
+    // The vertical move has already been resolved, so sweep sideways from where it ended up
+    glm::vec3 origin       = glm::vec3(m_step_origin.x, position_y(), 0.0f);
+    glm::vec3 displacement = glm::vec3(position_x() - m_step_origin.x, 0.0f, 0.0f);
     
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices);
-    glEnableVertexAttribArray(program->positionAttribute);
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, tex_coords);
-    glEnableVertexAttribArray(program->texCoordAttribute);
+    TileHit hit;
+    if (!map->sweep(origin, width(), height(), displacement, &hit)) return;
     
-    glDrawArrays(GL_TRIANGLES, 0, 6);
+    position_x() = origin.x + displacement.x * hit.time;
+    velocity_x() = 0;
     
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    if (hit.normal.x > 0.0f) m_collided_left  = true;
+    else                     m_collided_right = true;
 }
 
 bool const Entity::check_collision(Entity *other) const
@@ -380,10 +367,10 @@ bool const Entity::check_collision(Entity *other) const
     if (other == this) return false;
     
     // If either entity is inactive, there shouldn't be any collision
-    if (!m_is_active || !other->m_is_active) return false;
+    if (!get_is_active() || !other->get_is_active()) return false;
     
-    float x_distance = fabs(m_position.x - other->get_position().x) - ((m_width  + other->get_width())  / 2.0f);
-    float y_distance = fabs(m_position.y - other->get_position().y) - ((m_height + other->get_height()) / 2.0f);
+    float x_distance = fabs(position_x() - other->get_position().x) - ((width()  + other->get_width())  / 2.0f);
+    float y_distance = fabs(position_y() - other->get_position().y) - ((height() + other->get_height()) / 2.0f);
     
     return x_distance < 0.0f && y_distance < 0.0f;
 }
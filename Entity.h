@@ -1,14 +1,59 @@
 #pragma once
-#include "Map.h"
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "TileGrid.h"
+#include "LevelFile.h"
+#include "EntityPool.h"
+
+class SpatialHash;
+class Entity;
+
+enum CollisionEventType { STOMP, HIT, LANDED };
+
+/**
+    Something that happened to an entity during a step. STOMP: subject landed on other. HIT: subject ran into
+    other from the side or below. LANDED: subject touched the ground after being airborne; other is NULL.
+*/
+struct CollisionEvent
+{
+    CollisionEventType type;
+    Entity            *subject;
+    Entity            *other;
+};
 
 enum EntityType { PLATFORM, PLAYER, ENEMY  };
 enum AIType     { WALKER, GUARD, JUMPER     };
 enum AIState    { WALKING, IDLE, ATTACKING };
 
+/**
+    Everything about an entity that changes during play. Plain data, so a level restart is a straight copy.
+*/
+struct EntitySnapshot
+{
+    bool      is_active;
+    AIState   ai_state;
+    glm::vec3 position;
+    glm::vec3 velocity;
+    glm::vec3 acceleration;
+    glm::vec3 movement;
+    float     speed;
+    int      *animation_indices;
+    int       animation_index;
+    float     animation_time;
+    bool      is_jumping;
+    float     jumping_power;
+};
+
+/**
+    A handle onto one slot of an EntityPool plus the gameplay state that doesn't take part in integration.
+    Position, velocity, acceleration, movement, speed and extents all live in the pool.
+*/
 class Entity
 {
 private:
-    bool       m_is_active = true;
+    EntityPool *m_pool = NULL;
+    int         m_slot = -1;
+    
     EntityType m_entity_type;
     AIType     m_ai_type;
     AIState    m_ai_state;
@@ -18,12 +63,18 @@ private:
     int *m_animation_up    = NULL; // move upwards
     int *m_animation_down  = NULL; // move downwards
     
-    glm::vec3 m_position;
-    glm::vec3 m_velocity;
-    glm::vec3 m_acceleration;
+    bool      m_was_on_ground = false;
+    glm::vec3 m_step_origin;   // Where this step started, for the tile sweeps
+    
+    float &position_x()       const { return m_pool->m_position_x[m_slot]; }
+    float &position_y()       const { return m_pool->m_position_y[m_slot]; }
+    float &velocity_x()       const { return m_pool->m_velocity_x[m_slot]; }
+    float &velocity_y()       const { return m_pool->m_velocity_y[m_slot]; }
+    float  const width()      const { return m_pool->m_width[m_slot];      }
+    float  const height()     const { return m_pool->m_height[m_slot];     }
     
-    float m_width  = 0.8f;
-    float m_height = 0.8f;
+    bool resolve_collision_y(Entity *collidable_entity);
+    bool resolve_collision_x(Entity *collidable_entity);
     
 public:
     // Static attributes
@@ -34,12 +85,8 @@ public:
                      DOWN  = 3;
     
     // Existing
-    GLuint    m_texture_id;
-    glm::mat4 m_model_matrix;
-    
-    // Translating
-    float     m_speed;
-    glm::vec3 m_movement;
+    unsigned int m_texture_id; // A GL texture name, but the simulation never touches GL
+    glm::vec4    m_sprite_region = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f); // The sheet's part of that texture, when it's an atlas page
     
     // Player lives
     int m_death_count = 0;
@@ -64,12 +111,23 @@ public:
     bool m_collided_right  = false;
 
     // Methods
-    Entity();
+    Entity();                  // Unbound; call bind() before use, e.g. for arrays
+    Entity(EntityPool *pool);
     ~Entity();
 
-    void draw_sprite_from_texture_atlas(ShaderProgram *program, GLuint texture_id, int index);
-    void update(float delta_time, Entity *player, Entity *objects, int object_count, Map *map);
-    void render(ShaderProgram *program);
+    void bind(EntityPool *pool);
+
+    void spawn(const LevelSpawn &spawn);
+    EntitySnapshot const capture() const;
+    void restore(const EntitySnapshot &snapshot);
+    
+    // One step is split around the pool's integration kernels: begin_step, integrate, resolve_y, advance_x,
+    // resolve_x, end_step. Scene::step drives it.
+    void begin_step(float delta_time, Entity *player);
+    void resolve_y(TileGrid *map, SpatialHash *spatial_hash, std::vector<CollisionEvent> *events);
+    void resolve_x(TileGrid *map, SpatialHash *spatial_hash, std::vector<CollisionEvent> *events);
+    void end_step(std::vector<CollisionEvent> *events);
+    
     void ai_activate(Entity *player);
     void ai_walker(Entity *player);
     void ai_jumper(Entity *player);
@@ -77,35 +135,41 @@ public:
     
     void const check_collision_y(Entity *collidable_entities, int collidable_entity_count);
     void const check_collision_x(Entity *collidable_entities, int collidable_entity_count);
-    void const check_collision_y(Map *map);
-    void const check_collision_x(Map *map);
+    void const check_collision_y(TileGrid *map);
+    void const check_collision_x(TileGrid *map);
+    Entity    *check_collision_y(SpatialHash *spatial_hash);
+    Entity    *check_collision_x(SpatialHash *spatial_hash);
     
     bool const check_collision(Entity *other) const;
     
-    void activate()   { m_is_active = true;  };
-    void deactivate() { m_is_active = false; };
+    void activate()   { m_pool->m_active[m_slot] = 1.0f; };
+    void deactivate() { m_pool->m_active[m_slot] = 0.0f; };
     
     EntityType const get_entity_type()  const { return m_entity_type;  };
     AIType     const get_ai_type()      const { return m_ai_type;      };
     AIState    const get_ai_state()     const { return m_ai_state;     };
-    glm::vec3  const get_position()     const { return m_position;     };
-    glm::vec3  const get_movement()     const { return m_movement;     };
-    glm::vec3  const get_velocity()     const { return m_velocity;     };
-    glm::vec3  const get_acceleration() const { return m_acceleration; };
-    int        const get_width()        const { return m_width;        };
-    int        const get_height()       const { return m_height;       };
-    bool       const get_is_active()    const { return m_is_active;    };
+    glm::vec3  const get_position()     const { return glm::vec3(position_x(), position_y(), 0.0f); };
+    glm::vec3  const get_movement()     const { return glm::vec3(m_pool->m_movement_x[m_slot], m_pool->m_movement_y[m_slot], 0.0f); };
+    glm::vec3  const get_velocity()     const { return glm::vec3(velocity_x(), velocity_y(), 0.0f); };
+    glm::vec3  const get_acceleration() const { return glm::vec3(m_pool->m_acceleration_x[m_slot], m_pool->m_acceleration_y[m_slot], 0.0f); };
+    float      const get_width()        const { return width();                    };
+    float      const get_height()       const { return height();                   };
+    float      const get_speed()        const { return m_pool->m_speed[m_slot];    };
+    bool       const get_is_active()    const { return m_pool->m_active[m_slot] != 0.0f; };
+    glm::vec4  const get_sprite_uv()    const;
+    
+    glm::vec3  const get_previous_position() const { return glm::vec3(m_pool->m_previous_position_x[m_slot], m_pool->m_previous_position_y[m_slot], 0.0f); }; // Before the last step
     
     void const set_entity_type(EntityType new_entity_type)  { m_entity_type  = new_entity_type;      };
     void const set_ai_type(AIType new_ai_type)              { m_ai_type      = new_ai_type;          };
     void const set_ai_state(AIState new_state)              { m_ai_state     = new_state;            };
-    void const set_position(glm::vec3 new_position)         { m_position     = new_position;         };
-    void const set_movement(glm::vec3 new_movement)         { m_movement     = new_movement;         };
-    void const set_velocity(glm::vec3 new_velocity)         { m_velocity     = new_velocity;         };
-    void const set_acceleration(glm::vec3 new_acceleration) { m_acceleration = new_acceleration;     };
-    void const set_width(float new_width)                   { m_width        = new_width;            };
-    void const set_height(float new_height)                 { m_height       = new_height;           };
-    void const set_speed(float new_speed)                   { m_speed        = new_speed;            };
+    void const set_position(glm::vec3 new_position)         { position_x() = new_position.x; position_y() = new_position.y; };
+    void const set_movement(glm::vec3 new_movement)         { m_pool->m_movement_x[m_slot] = new_movement.x; m_pool->m_movement_y[m_slot] = new_movement.y; };
+    void const set_velocity(glm::vec3 new_velocity)         { velocity_x() = new_velocity.x; velocity_y() = new_velocity.y; };
+    void const set_acceleration(glm::vec3 new_acceleration) { m_pool->m_acceleration_x[m_slot] = new_acceleration.x; m_pool->m_acceleration_y[m_slot] = new_acceleration.y; };
+    void const set_width(float new_width)                   { m_pool->m_width[m_slot]  = new_width;  };
+    void const set_height(float new_height)                 { m_pool->m_height[m_slot] = new_height; };
+    void const set_speed(float new_speed)                   { m_pool->m_speed[m_slot]  = new_speed;  };
     void const set_jumping_power(float new_jumping_power)   { m_jumping_power = new_jumping_power;   };
     void const set_death_count(int new_death_count)         { m_death_count  = new_death_count;      };
 
@@ -0,0 +1,144 @@
+#include "EntityPool.h"
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define ENTITY_POOL_SSE 1
+#include <xmmintrin.h>
+
+// new where mask is all ones, old where it's all zeros. The lanes compute exactly what the scalar loop does and
+// only pick between results, so both paths agree bit for bit, even on infinities and NaNs in inactive slots.
+static inline __m128 select_lanes(__m128 mask, __m128 new_value, __m128 old_value)
+{
+    return _mm_or_ps(_mm_and_ps(mask, new_value), _mm_andnot_ps(mask, old_value));
+}
+#endif
+
+int EntityPool::allocate()
+{
+    m_position_x.push_back(0.0f);
+    m_position_y.push_back(0.0f);
+    m_velocity_x.push_back(0.0f);
+    m_velocity_y.push_back(0.0f);
+    m_acceleration_x.push_back(0.0f);
+    m_acceleration_y.push_back(0.0f);
+    m_movement_x.push_back(0.0f);
+    m_movement_y.push_back(0.0f);
+    m_speed.push_back(0.0f);
+    m_width.push_back(0.8f);
+    m_height.push_back(0.8f);
+    m_active.push_back(1.0f);
+    m_previous_position_x.push_back(0.0f);
+    m_previous_position_y.push_back(0.0f);
+
+    return get_size() - 1;
+}
+
+void EntityPool::clear()
+{
+    m_position_x.clear();
+    m_position_y.clear();
+    m_velocity_x.clear();
+    m_velocity_y.clear();
+    m_acceleration_x.clear();
+    m_acceleration_y.clear();
+    m_movement_x.clear();
+    m_movement_y.clear();
+    m_speed.clear();
+    m_width.clear();
+    m_height.clear();
+    m_active.clear();
+    m_previous_position_x.clear();
+    m_previous_position_y.clear();
+}
+
+void EntityPool::integrate(float delta_time)
+{
+    int count = get_size();
+    int i = 0;
+
+    float       *velocity_x     = m_velocity_x.data();
+    float       *velocity_y     = m_velocity_y.data();
+    float       *position_y     = m_position_y.data();
+    const float *acceleration_x = m_acceleration_x.data();
+    const float *acceleration_y = m_acceleration_y.data();
+    const float *movement_x     = m_movement_x.data();
+    const float *speed          = m_speed.data();
+    const float *active         = m_active.data();
+
+#ifdef ENTITY_POOL_SSE
+    __m128 dt   = _mm_set1_ps(delta_time);
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 mask = _mm_cmpneq_ps(_mm_loadu_ps(active + i), zero);
+
+        // x: walking speed replaces the old velocity, then acceleration is added on top
+        __m128 new_velocity_x = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(movement_x + i), _mm_loadu_ps(speed + i)),
+                                           _mm_mul_ps(_mm_loadu_ps(acceleration_x + i), dt));
+        _mm_storeu_ps(velocity_x + i, select_lanes(mask, new_velocity_x, _mm_loadu_ps(velocity_x + i)));
+
+        // y: accumulate, then advance the position with the new velocity
+        __m128 old_velocity_y = _mm_loadu_ps(velocity_y + i);
+        __m128 old_position_y = _mm_loadu_ps(position_y + i);
+        __m128 new_velocity_y = _mm_add_ps(old_velocity_y, _mm_mul_ps(_mm_loadu_ps(acceleration_y + i), dt));
+        __m128 new_position_y = _mm_add_ps(old_position_y, _mm_mul_ps(new_velocity_y, dt));
+        _mm_storeu_ps(velocity_y + i, select_lanes(mask, new_velocity_y, old_velocity_y));
+        _mm_storeu_ps(position_y + i, select_lanes(mask, new_position_y, old_position_y));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (active[i] == 0.0f) continue;
+
+        velocity_x[i]  = movement_x[i] * speed[i] + acceleration_x[i] * delta_time;
+        velocity_y[i] += acceleration_y[i] * delta_time;
+        position_y[i] += velocity_y[i] * delta_time;
+    }
+}
+
+void EntityPool::advance_x(float delta_time)
+{
+    int count = get_size();
+    int i = 0;
+
+    float       *position_x = m_position_x.data();
+    const float *velocity_x = m_velocity_x.data();
+    const float *active     = m_active.data();
+
+#ifdef ENTITY_POOL_SSE
+    __m128 dt   = _mm_set1_ps(delta_time);
+    __m128 zero = _mm_setzero_ps();
+
+    for (; i + 4 <= count; i += 4)
+    {
+        __m128 mask           = _mm_cmpneq_ps(_mm_loadu_ps(active + i), zero);
+        __m128 old_position_x = _mm_loadu_ps(position_x + i);
+        __m128 new_position_x = _mm_add_ps(old_position_x, _mm_mul_ps(_mm_loadu_ps(velocity_x + i), dt));
+        _mm_storeu_ps(position_x + i, select_lanes(mask, new_position_x, old_position_x));
+    }
+#endif
+
+    for (; i < count; i++)
+    {
+        if (active[i] != 0.0f) position_x[i] += velocity_x[i] * delta_time;
+    }
+}
+
+void EntityPool::store_previous_positions()
+{
+    // Same sizes every time, so these copies never allocate
+    m_previous_position_x = m_position_x;
+    m_previous_position_y = m_position_y;
+}
+
+bool const EntityPool::has_moved() const
+{
+    for (int i = 0; i < get_size(); i++)
+    {
+        if (m_active[i] == 0.0f) continue;
+        if (m_position_x[i] != m_previous_position_x[i] || m_position_y[i] != m_previous_position_y[i]) return true;
+    }
+
+    return false;
+}
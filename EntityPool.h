@@ -0,0 +1,43 @@
+#pragma once
+#include <vector>
+
+/**
+    The physics half of every entity in a scene, stored one field per array. Entities only keep a slot index
+    into the pool, so the integration kernels stream through exactly the floats they need and nothing else.
+*/
+class EntityPool {
+public:
+    // ————— ATTRIBUTES ————— //
+    std::vector<float> m_position_x;
+    std::vector<float> m_position_y;
+    std::vector<float> m_velocity_x;
+    std::vector<float> m_velocity_y;
+    std::vector<float> m_acceleration_x;
+    std::vector<float> m_acceleration_y;
+    std::vector<float> m_movement_x;
+    std::vector<float> m_movement_y;
+    std::vector<float> m_speed;
+    std::vector<float> m_width;
+    std::vector<float> m_height;
+    std::vector<float> m_active; // 1.0f or 0.0f, a float so the kernels can compare it into a lane mask
+
+    // Where every entity was before the current step; rendering blends between these and the positions above
+    std::vector<float> m_previous_position_x;
+    std::vector<float> m_previous_position_y;
+
+    // ————— METHODS ————— //
+    int  allocate();
+    void clear();
+
+    // Both kernels leave inactive slots untouched
+    void integrate(float delta_time); // Velocity from movement and acceleration, then the y advance
+    void advance_x(float delta_time);
+
+    // Makes the current positions the previous ones: before each step, and after a teleport so nothing
+    // is drawn sliding across the level
+    void store_previous_positions();
+    bool const has_moved() const; // Whether any active entity's previous and current positions differ
+
+    // ————— GETTERS ————— //
+    int const get_size() const { return (int) m_position_x.size(); }
+};
@@ -0,0 +1,118 @@
+#include "FramePacer.h"
+#include "Profiler.h"
+#include <SDL.h>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <thread>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+static const char *MODE_NAMES[PACING_MODE_COUNT] = { "vsync", "capped", "uncapped" };
+
+FramePacer::FramePacer(PacingMode mode, double target_fps) : m_mode(mode), m_target_fps(target_fps)
+{
+    m_mode_start_ns  = Profiler::now_ns();
+    m_mode_start_cpu = std::clock();
+}
+
+void FramePacer::close_usage()
+{
+    uint64_t     now_ns  = Profiler::now_ns();
+    std::clock_t now_cpu = std::clock();
+
+    // std::clock is CPU time for the whole process, worker threads included
+    m_usage[m_mode].m_wall_seconds += (now_ns - m_mode_start_ns) / 1e9;
+    m_usage[m_mode].m_cpu_seconds  += (double) (now_cpu - m_mode_start_cpu) / CLOCKS_PER_SEC;
+
+    m_mode_start_ns  = now_ns;
+    m_mode_start_cpu = now_cpu;
+}
+
+void FramePacer::set_mode(PacingMode mode)
+{
+    close_usage();
+
+    if (mode == PACING_VSYNC && SDL_GL_SetSwapInterval(1) != 0)
+    {
+        LOG("Vsync isn't available (" << SDL_GetError() << "); capping at " << m_target_fps << " fps instead");
+        mode = PACING_CAPPED;
+    }
+
+    if (mode != PACING_VSYNC) SDL_GL_SetSwapInterval(0);
+
+    m_mode          = mode;
+    m_next_frame_ns = 0;
+
+    LOG("Frame pacing: " << get_mode_name(m_mode));
+}
+
+void FramePacer::wait_until(uint64_t deadline_ns)
+{
+    uint64_t now_ns = Profiler::now_ns();
+
+    if (deadline_ns > now_ns + SPIN_TAIL_NS)
+    {
+        std::this_thread::sleep_for(std::chrono::nanoseconds(deadline_ns - now_ns - SPIN_TAIL_NS));
+    }
+
+    while (Profiler::now_ns() < deadline_ns) std::this_thread::yield();
+}
+
+void FramePacer::wait_for_next_frame()
+{
+    if (m_mode != PACING_CAPPED) return;
+
+    ProfileScope scope(PHASE_WAIT);
+
+    uint64_t period_ns = (uint64_t) (1e9 / m_target_fps);
+    uint64_t now_ns    = Profiler::now_ns();
+
+    // Deadlines advance by whole periods so the rate doesn't drift, but a frame that ran long starts a new
+    // schedule rather than being followed by a burst of short ones
+    m_next_frame_ns = m_next_frame_ns == 0 ? now_ns + period_ns : m_next_frame_ns + period_ns;
+    if (m_next_frame_ns < now_ns) m_next_frame_ns = now_ns + period_ns;
+
+    wait_until(m_next_frame_ns);
+}
+
+void FramePacer::count_frame(bool was_rendered)
+{
+    m_usage[m_mode].m_frame_count++;
+    if (was_rendered) m_usage[m_mode].m_rendered_count++;
+}
+
+void FramePacer::log_usage()
+{
+    close_usage();
+
+    for (int mode = 0; mode < PACING_MODE_COUNT; mode++)
+    {
+        const ModeUsage &usage = m_usage[mode];
+        if (usage.m_frame_count == 0 || usage.m_wall_seconds <= 0.0) continue;
+
+        LOG(MODE_NAMES[mode] << ": " << usage.m_rendered_count << " of " << usage.m_frame_count << " frames rendered in "
+            << usage.m_wall_seconds << " s (" << usage.m_rendered_count / usage.m_wall_seconds << " fps), CPU "
+            << 100.0 * usage.m_cpu_seconds / usage.m_wall_seconds << "% of a core");
+    }
+}
+
+bool FramePacer::parse_mode(const char *name, PacingMode *mode)
+{
+    for (int candidate = 0; candidate < PACING_MODE_COUNT; candidate++)
+    {
+        if (strcmp(name, MODE_NAMES[candidate]) == 0)
+        {
+            *mode = (PacingMode) candidate;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+const char *FramePacer::get_mode_name(PacingMode mode)
+{
+    return MODE_NAMES[mode];
+}
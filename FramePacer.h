@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <ctime>
+
+enum PacingMode { PACING_VSYNC, PACING_CAPPED, PACING_UNCAPPED, PACING_MODE_COUNT };
+
+/**
+    Decides how the main loop waits between frames. VSYNC lets the swap block until the display is ready,
+    CAPPED sleeps until the next frame is due at the target rate and UNCAPPED doesn't wait at all. Waits sleep
+    most of the way and spin through the last stretch, since a plain sleep can overshoot by a millisecond or
+    more.
+
+    It also keeps count of the wall and CPU time spent in each mode, so switching modes in one session gives a
+    direct comparison.
+*/
+class FramePacer {
+private:
+    struct ModeUsage
+    {
+        double m_wall_seconds   = 0.0;
+        double m_cpu_seconds    = 0.0;
+        int    m_frame_count    = 0; // Passes through the main loop
+        int    m_rendered_count = 0; // Of those, how many drew and presented anything
+    };
+
+    PacingMode m_mode;
+    double     m_target_fps;
+    uint64_t   m_next_frame_ns = 0;
+
+    ModeUsage    m_usage[PACING_MODE_COUNT];
+    uint64_t     m_mode_start_ns;
+    std::clock_t m_mode_start_cpu;
+
+    void close_usage();
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const uint64_t SPIN_TAIL_NS = 1500000; // The last 1.5 ms of a wait spins instead of sleeping
+    static const int      DEFAULT_FPS  = 60;
+
+    // ————— CONSTRUCTOR ————— //
+    FramePacer(PacingMode mode, double target_fps);
+
+    // ————— METHODS ————— //
+    // Sets the swap interval for the mode; needs the GL context. A driver that won't do vsync falls back to CAPPED.
+    void set_mode(PacingMode mode);
+    void cycle_mode() { set_mode((PacingMode) ((m_mode + 1) % PACING_MODE_COUNT)); }
+
+    // After presenting a frame: in CAPPED, waits until the next one is due
+    void wait_for_next_frame();
+
+    // Sleeps, then spins, until Profiler::now_ns() reaches deadline_ns
+    static void wait_until(uint64_t deadline_ns);
+
+    void count_frame(bool was_rendered);
+
+    // One line per mode that was used this session
+    void log_usage();
+
+    static bool        parse_mode(const char *name, PacingMode *mode);
+    static const char *get_mode_name(PacingMode mode);
+
+    // ————— GETTERS ————— //
+    PacingMode const get_mode()       const { return m_mode;       }
+    double     const get_target_fps() const { return m_target_fps; }
+};
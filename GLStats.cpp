@@ -0,0 +1,86 @@
+#include "GLStats.h"
+#include <cstring>
+#include <iostream>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+uint64_t      GLStats::s_counts[SUBSYSTEM_COUNT][STAT_COUNT]     = {};
+uint64_t      GLStats::s_last_frame[SUBSYSTEM_COUNT][STAT_COUNT] = {};
+GLSubsystem   GLStats::s_subsystem   = SUBSYSTEM_FRAME;
+int           GLStats::s_scope_depth = 0;
+uint32_t      GLStats::s_frame       = 0;
+std::ofstream GLStats::s_log;
+
+GLuint GLStats::s_program        = 0,
+       GLStats::s_texture        = 0,
+       GLStats::s_array_buffer   = 0,
+       GLStats::s_element_buffer = 0;
+
+static const char *SUBSYSTEM_NAMES[SUBSYSTEM_COUNT] = { "frame", "map", "sprites", "text", "effects", "profiler", "assets" };
+
+static const char *STAT_NAMES[STAT_COUNT] = {
+    "draw_calls", "vertices", "program_switches", "texture_binds", "buffer_binds", "attribute_toggles",
+    "upload_bytes", "redundant_binds"
+};
+
+void GLStats::end_frame()
+{
+    memcpy(s_last_frame, s_counts, sizeof(s_counts));
+    memset(s_counts, 0, sizeof(s_counts));
+
+    if (s_log.is_open())
+    {
+        for (int subsystem = 0; subsystem < SUBSYSTEM_COUNT; subsystem++)
+        {
+            const uint64_t *counts = s_last_frame[subsystem];
+
+            bool is_empty = true;
+            for (int stat = 0; stat < STAT_COUNT; stat++) is_empty = is_empty && counts[stat] == 0;
+            if (is_empty) continue;
+
+            s_log << s_frame << ',' << SUBSYSTEM_NAMES[subsystem];
+            for (int stat = 0; stat < STAT_COUNT; stat++) s_log << ',' << counts[stat];
+            s_log << '\n';
+        }
+    }
+
+    s_frame++;
+}
+
+bool GLStats::open_log(const char *filepath)
+{
+    s_log.open(filepath);
+    if (!s_log)
+    {
+        LOG("Unable to write GL stats " << filepath);
+        return false;
+    }
+
+    s_log << "frame,subsystem";
+    for (int stat = 0; stat < STAT_COUNT; stat++) s_log << ',' << STAT_NAMES[stat];
+    s_log << '\n';
+
+    return true;
+}
+
+void GLStats::close_log()
+{
+    if (s_log.is_open()) s_log.close();
+}
+
+uint64_t const GLStats::get_last_frame_total(GLStat stat)
+{
+    uint64_t total = 0;
+    for (int subsystem = 0; subsystem < SUBSYSTEM_COUNT; subsystem++) total += s_last_frame[subsystem][stat];
+    return total;
+}
+
+const char *GLStats::get_subsystem_name(GLSubsystem subsystem)
+{
+    return SUBSYSTEM_NAMES[subsystem];
+}
+
+const char *GLStats::get_stat_name(GLStat stat)
+{
+    return STAT_NAMES[stat];
+}
@@ -0,0 +1,139 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <cstdint>
+#include <fstream>
+#include <SDL.h>
+#include <SDL_opengl.h>
+
+// Who issued a call. FRAME is main.cpp's own per-frame work and anything nobody claimed.
+enum GLSubsystem { SUBSYSTEM_FRAME, SUBSYSTEM_MAP, SUBSYSTEM_SPRITES, SUBSYSTEM_TEXT, SUBSYSTEM_EFFECTS,
+                   SUBSYSTEM_PROFILER, SUBSYSTEM_ASSETS, SUBSYSTEM_COUNT };
+
+enum GLStat { STAT_DRAW_CALLS, STAT_VERTICES, STAT_PROGRAM_SWITCHES, STAT_TEXTURE_BINDS, STAT_BUFFER_BINDS,
+              STAT_ATTRIBUTE_TOGGLES, STAT_UPLOAD_BYTES, STAT_REDUNDANT_BINDS, STAT_COUNT };
+
+/**
+    Counts the GL calls that cost a frame something, per subsystem. Render code calls these wrappers instead
+    of the gl* functions they forward to. A bind of the program, texture or buffer that the wrappers last
+    bound is still made, but is also counted as redundant.
+*/
+class GLStats {
+private:
+    static uint64_t    s_counts[SUBSYSTEM_COUNT][STAT_COUNT];
+    static uint64_t    s_last_frame[SUBSYSTEM_COUNT][STAT_COUNT];
+    static GLSubsystem s_subsystem;
+    static int         s_scope_depth;
+    static uint32_t    s_frame;
+    static std::ofstream s_log;
+
+    static GLuint s_program, s_texture, s_array_buffer, s_element_buffer;
+
+    static void add(GLStat stat, uint64_t amount = 1) { s_counts[s_subsystem][stat] += amount; }
+
+    friend class GLStatsScope;
+
+public:
+    // ————— WRAPPERS ————— //
+    static void use_program(GLuint program)
+    {
+        add(program == s_program ? STAT_REDUNDANT_BINDS : STAT_PROGRAM_SWITCHES);
+        s_program = program;
+        glUseProgram(program);
+    }
+
+    static void bind_texture(GLenum target, GLuint texture)
+    {
+        add(target == GL_TEXTURE_2D && texture == s_texture ? STAT_REDUNDANT_BINDS : STAT_TEXTURE_BINDS);
+        if (target == GL_TEXTURE_2D) s_texture = texture;
+        glBindTexture(target, texture);
+    }
+
+    static void bind_buffer(GLenum target, GLuint buffer)
+    {
+        GLuint *bound = target == GL_ARRAY_BUFFER ? &s_array_buffer : &s_element_buffer;
+        add(buffer == *bound ? STAT_REDUNDANT_BINDS : STAT_BUFFER_BINDS);
+        *bound = buffer;
+        glBindBuffer(target, buffer);
+    }
+
+    static void buffer_data(GLenum target, GLsizeiptr size, const void *data, GLenum usage)
+    {
+        add(STAT_UPLOAD_BYTES, size);
+        glBufferData(target, size, data, usage);
+    }
+
+    static void tex_image_2d(GLenum target, GLint level, GLint internal_format, GLsizei width, GLsizei height,
+                             GLint border, GLenum format, GLenum type, const void *pixels)
+    {
+        // Every texture here is RGBA, either a byte per channel or (baked compact textures) 16 bits a texel
+        add(STAT_UPLOAD_BYTES, (uint64_t) width * height * (type == GL_UNSIGNED_SHORT_4_4_4_4 ? 2 : 4));
+        glTexImage2D(target, level, internal_format, width, height, border, format, type, pixels);
+    }
+
+    static void enable_attribute(GLuint index)
+    {
+        add(STAT_ATTRIBUTE_TOGGLES);
+        glEnableVertexAttribArray(index);
+    }
+
+    static void disable_attribute(GLuint index)
+    {
+        add(STAT_ATTRIBUTE_TOGGLES);
+        glDisableVertexAttribArray(index);
+    }
+
+    static void draw_arrays(GLenum mode, GLint first, GLsizei count)
+    {
+        add(STAT_DRAW_CALLS);
+        add(STAT_VERTICES, count);
+        glDrawArrays(mode, first, count);
+    }
+
+    static void draw_elements(GLenum mode, GLsizei count, GLenum type, const void *indices)
+    {
+        add(STAT_DRAW_CALLS);
+        add(STAT_VERTICES, count);
+        glDrawElements(mode, count, type, indices);
+    }
+
+    // ————— METHODS ————— //
+    // Moves this frame's counts to the last-frame slots (and the log, if open) and starts again from zero
+    static void end_frame();
+
+    // Writes one CSV row per frame and subsystem that made any counted call, until close_log
+    static bool open_log(const char *filepath);
+    static void close_log();
+
+    // ————— GETTERS ————— //
+    static uint64_t const get_last_frame(GLSubsystem subsystem, GLStat stat) { return s_last_frame[subsystem][stat]; }
+    static uint64_t const get_last_frame_total(GLStat stat);
+    static const char    *get_subsystem_name(GLSubsystem subsystem);
+    static const char    *get_stat_name(GLStat stat);
+};
+
+/**
+    Charges every counted call made while it's alive to one subsystem. Scopes nest, and the outermost one
+    wins, so a caller can claim whatever a shared helper (e.g. a TextRenderer) does on its behalf.
+*/
+class GLStatsScope {
+private:
+    GLSubsystem m_previous;
+
+public:
+    GLStatsScope(GLSubsystem subsystem) : m_previous(GLStats::s_subsystem)
+    {
+        if (GLStats::s_scope_depth++ == 0) GLStats::s_subsystem = subsystem;
+    }
+
+    ~GLStatsScope()
+    {
+        --GLStats::s_scope_depth;
+        GLStats::s_subsystem = m_previous;
+    }
+};
@@ -0,0 +1,51 @@
+#include "InputQueue.h"
+#include "Replay.h"
+
+InputQueue::InputQueue() : m_write_index(0), m_read_index(0)
+{
+}
+
+bool InputQueue::push(InputEventType type, uint8_t bit, uint64_t timestamp_ns)
+{
+    uint32_t write_index = m_write_index.load(std::memory_order_relaxed);
+
+    // The indices only ever grow, so their difference is the queue's size even after they wrap
+    if (write_index - m_read_index.load(std::memory_order_acquire) == CAPACITY) return false;
+
+    if (timestamp_ns < m_last_timestamp_ns) timestamp_ns = m_last_timestamp_ns;
+    m_last_timestamp_ns = timestamp_ns;
+
+    m_events[write_index & (CAPACITY - 1)] = InputEvent { timestamp_ns, (uint8_t) type, bit };
+    m_write_index.store(write_index + 1, std::memory_order_release);
+
+    return true;
+}
+
+uint8_t InputQueue::take_tick(uint64_t tick_end_ns)
+{
+    uint32_t read_index  = m_read_index.load(std::memory_order_relaxed);
+    uint32_t write_index = m_write_index.load(std::memory_order_acquire);
+
+    uint8_t pressed = 0;
+
+    // Events are in timestamp order, so the first one past the tick ends it
+    for (; read_index != write_index; read_index++)
+    {
+        const InputEvent &event = m_events[read_index & (CAPACITY - 1)];
+        if (event.timestamp_ns > tick_end_ns) break;
+
+        if (event.type == INPUT_PRESS)
+        {
+            pressed |= event.bit;
+            if (event.bit & (INPUT_LEFT | INPUT_RIGHT)) m_held |= event.bit;
+        }
+        else
+        {
+            m_held &= ~event.bit;
+        }
+    }
+
+    m_read_index.store(read_index, std::memory_order_release);
+
+    return m_held | pressed;
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+enum InputEventType { INPUT_PRESS, INPUT_RELEASE };
+
+/**
+    One key going down or up, as the InputBit it maps to, stamped on the Profiler::now_ns() clock.
+*/
+struct InputEvent
+{
+    uint64_t timestamp_ns;
+    uint8_t  type; // InputEventType
+    uint8_t  bit;  // InputBit
+};
+
+/**
+    Player input on its way from whoever reads SDL's events to the fixed-step loop. One thread pushes events
+    and one thread takes them, with no locks: each side only ever writes its own index, and publishes it with
+    a release store after the slot it covers is written or read.
+
+    The taking side turns events into one InputBit byte per tick. take_tick only consumes events that happened
+    before that tick's slice of real time ended, so when one frame runs several steps each of them sees the keys
+    as they were at its own time. A key pressed and released between two frames still reaches a tick.
+*/
+class InputQueue {
+private:
+    static const int CAPACITY = 256;
+    static_assert((CAPACITY & (CAPACITY - 1)) == 0, "The indices are masked into the ring");
+
+    InputEvent m_events[CAPACITY];
+
+    // On separate cache lines, so the two threads don't contend for one
+    alignas(64) std::atomic<uint32_t> m_write_index;
+    alignas(64) std::atomic<uint32_t> m_read_index;
+
+    // Taking side only
+    uint8_t m_held = 0;
+
+    // Pushing side only
+    uint64_t m_last_timestamp_ns = 0;
+
+public:
+    // ————— CONSTRUCTOR ————— //
+    InputQueue();
+
+    // ————— METHODS ————— //
+    // Pushing thread only. Timestamps are kept in order, so an event can't be stamped before one already
+    // pushed. Returns false, dropping the event, when the taking side has fallen a whole queue behind.
+    bool push(InputEventType type, uint8_t bit, uint64_t timestamp_ns);
+
+    // Taking thread only. Applies every event stamped at or before tick_end_ns and returns the tick's input:
+    // every key held at the end of it, plus every key pressed during it.
+    uint8_t take_tick(uint64_t tick_end_ns);
+};
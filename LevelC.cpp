@@ -1,51 +1,50 @@
 #include "LevelC.hpp"
-#include "Utility.h"
+#include "AssetCache.h"
 #define LOG(argument) std::cout << argument << '\n'
 
+// ————— ASSETS ————— //
+const char TILESET_FILEPATH[] = "/Users/chelsea/Desktop/Final/SDLProject/assets/tileset3.png",
+           PLAYER_FILEPATH[]  = "/Users/chelsea/Desktop/Final/SDLProject/assets/player.png",
+           ENEMY_FILEPATH[]   = "/Users/chelsea/Desktop/Final/SDLProject/assets/ghost.png",
+           BGM_FILEPATH[]     = "/Users/chelsea/Desktop/Final/SDLProject/assets/bgm(games).mp3",
+           JUMP_FILEPATH[]    = "/Users/chelsea/Desktop/Final/SDLProject/assets/jump.wav";
 
-#define LEVEL_WIDTH 14
-#define LEVEL_HEIGHT 8
-
-unsigned int LEVELC_DATA[] =
-{
-    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
-    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
-    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 2,
-    3, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
-    3, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
-    3, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0
-};
 
 LevelC::~LevelC()
 {
     delete [] m_state.enemies;
     delete    m_state.player;
     delete    m_state.map;
-    Mix_FreeChunk(m_state.jump_sfx);
-    Mix_FreeMusic(m_state.bgm);
 }
 
-void LevelC::initialise()
+void LevelC::preload()
+{
+    m_preloaded_textures = { AssetCache::request_sheet(TILESET_FILEPATH).m_texture,
+                             AssetCache::request_sheet(PLAYER_FILEPATH).m_texture,
+                             AssetCache::request_sheet(ENEMY_FILEPATH).m_texture };
+    m_preloaded_music    = { AssetCache::request_music(BGM_FILEPATH) };
+    m_preloaded_sounds   = { AssetCache::request_sound(JUMP_FILEPATH) };
+}
+
+bool LevelC::initialise()
 {
     m_state.next_scene_id = -1;
     
-    GLuint map_texture_id = Utility::load_texture("/Users/chelsea/Desktop/Final/SDLProject/assets/tileset3.png");
-    m_state.map = new Map(LEVEL_WIDTH, LEVEL_HEIGHT, LEVELC_DATA, map_texture_id, 1.0f, 4, 1);
+    SpriteSheet tileset = AssetCache::get_sheet(TILESET_FILEPATH);
+    std::shared_ptr<LevelFile> level = load_map("/Users/chelsea/Desktop/Final/SDLProject/assets/levelC.plvl", tileset, 4, 1);
+    if (level == nullptr) return false;
     
     // Code from main.cpp's initialise()
     /**
      George's Stuff
      */
     // Existing
-    m_state.player = new Entity();
-    m_state.player->set_entity_type(PLAYER);
-    m_state.player->set_position(glm::vec3(3.5f, 5.0f, 0.0f));
-    m_state.player->set_movement(glm::vec3(0.0f));
-    m_state.player->m_speed = 1.0f;
-    m_state.player->set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-    m_state.player->m_texture_id = Utility::load_texture("/Users/chelsea/Desktop/Final/SDLProject/assets/player.png");
+    m_state.player = new Entity(&m_entity_pool);
+    spawn_player(*level, m_state.player);
+    SpriteSheet player_sheet = AssetCache::get_sheet(PLAYER_FILEPATH);
+    m_state.player_texture = player_sheet.m_texture;
+    m_state.player->m_texture_id    = m_state.player_texture->m_id;
+    m_state.player->m_sprite_region = player_sheet.m_region;
     
     // Walking
     m_state.player->m_walking[m_state.player->LEFT]  = new int[4] { 5, 6, 7, 8     };
@@ -62,76 +61,34 @@ void LevelC::initialise()
     m_state.player->set_height(0.8f);
     m_state.player->set_width(0.8f);
     
-    // Jumping
-    m_state.player->m_jumping_power = 5.0f;
-    
     /**
      Enemies' stuff */
-    GLuint enemy_texture_id = Utility::load_texture("/Users/chelsea/Desktop/Final/SDLProject/assets/ghost.png");
+    SpriteSheet enemy_sheet = AssetCache::get_sheet(ENEMY_FILEPATH);
+    m_state.enemy_texture = enemy_sheet.m_texture;
     
-    m_state.enemies = new Entity[ENEMY_COUNT];
-    
-    for (int i = 0; i < ENEMY_COUNT; ++i) {
-        m_state.enemies[i].set_entity_type(ENEMY);
-
-        if (i == 0) {
-            m_state.enemies[i].set_ai_type(WALKER);
-            m_state.enemies[i].set_ai_state(IDLE);
-            m_state.enemies[i].m_texture_id = enemy_texture_id;
-            m_state.enemies[i].set_position(glm::vec3(6.0f, -5.0f, 0.0f));
-            m_state.enemies[i].set_movement(glm::vec3(0.0f));
-            m_state.enemies[i].set_speed(1.0f);
-            m_state.enemies[i].set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-        }
-        else if (i == 1){
-            m_state.enemies[i].set_ai_type(GUARD);
-            m_state.enemies[i].set_ai_state(IDLE);
-            m_state.enemies[i].set_jumping_power(2.0f);
-            m_state.enemies[i].m_texture_id = enemy_texture_id;
-            m_state.enemies[i].set_position(glm::vec3(4.0f, -5.0f, 0.0f));
-            m_state.enemies[i].set_movement(glm::vec3(0.0f));
-            m_state.enemies[i].set_speed(1.0f);
-            m_state.enemies[i].set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-        }
-        
-        else {
-            m_state.enemies[i].set_ai_type(JUMPER);
-            m_state.enemies[i].set_ai_state(IDLE);
-            m_state.enemies[i].set_jumping_power(2.0f);
-            m_state.enemies[i].m_texture_id = enemy_texture_id;
-            m_state.enemies[i].set_position(glm::vec3(2.0f, -5.0f, 0.0f));
-            m_state.enemies[i].set_movement(glm::vec3(0.0f));
-            m_state.enemies[i].set_speed(1.0f);
-            m_state.enemies[i].set_acceleration(glm::vec3(0.0f, -9.81f, 0.0f));
-        }
-    }
+    m_state.enemies = spawn_enemies(*level, m_state.enemy_texture->m_id, enemy_sheet.m_region, &ENEMY_COUNT);
     
     /**
      BGM and SFX
      */
-    Mix_OpenAudio(44100, MIX_DEFAULT_FORMAT, 2, 4096);
+    m_state.bgm = AssetCache::get_music(BGM_FILEPATH);
+    Audio::play_music(m_state.bgm.get(), -1);
+    Audio::set_music_volume(MIX_MAX_VOLUME / 2.0f);
     
-    m_state.bgm = Mix_LoadMUS("/Users/chelsea/Desktop/Final/SDLProject/assets/bgm(games).mp3");
-    Mix_PlayMusic(m_state.bgm, -1);
-    Mix_VolumeMusic(MIX_MAX_VOLUME / 2.0f);
+    m_state.jump_sfx = AssetCache::get_sound(JUMP_FILEPATH);
     
-    m_state.jump_sfx = Mix_LoadWAV("/Users/chelsea/Desktop/Final/SDLProject/assets/jump.wav");
+    // Restarts rewind to this point instead of running initialise() again
+    capture_snapshot();
+    return true;
 }
 
 void LevelC::update(float delta_time)
 {
-    for (int i = 0; i < ENEMY_COUNT; ++i){
-        if (m_state.enemies[i].get_ai_type() == JUMPER &&  m_state.enemies[i].m_collided_bottom == true) { m_state.enemies[i].ai_jumper(m_state.player);
-        }
-        m_state.player->update(delta_time, m_state.player, &(m_state.enemies[i]), ENEMY_COUNT, m_state.map);
-        m_state.enemies[i].update(delta_time, m_state.player, m_state.player, 1, m_state.map);
-       
-    }
+    step(delta_time);
 }
 
-void LevelC::render(ShaderProgram *program)
+void LevelC::capture_sprites(std::vector<RenderSprite> *sprites) const
 {
-    m_state.map->render(program);
-    m_state.player->render(program);
-    for (int i = 0; i < ENEMY_COUNT; ++i) m_state.enemies[i].render(program);
+    capture_sprite(m_state.player, sprites);
+    for (int i = 0; i < ENEMY_COUNT; ++i) capture_sprite(&m_state.enemies[i], sprites);
 }
@@ -0,0 +1,210 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "LevelFile.h"
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+static_assert(sizeof(LevelSpawn) == 28,       "LevelSpawn is stored verbatim on disk");
+static_assert(sizeof(LevelFileHeader) == 120, "LevelFileHeader is stored verbatim on disk");
+static_assert(sizeof(TileVertex) == 8,        "TileVertex is stored verbatim on disk");
+
+static const uint64_t FNV_PRIME = 1099511628211ull;
+
+uint64_t LevelFile::hash(const void *data, size_t size, uint64_t seed)
+{
+    // FNV-1a; plenty for spotting edits and corruption, which is all the cache key needs
+    const unsigned char *bytes = (const unsigned char *) data;
+    uint64_t result = seed;
+    
+    for (size_t i = 0; i < size; i++)
+    {
+        result ^= bytes[i];
+        result *= FNV_PRIME;
+    }
+    
+    return result;
+}
+
+uint64_t LevelFile::derived_key(uint64_t content_hash, int tile_count_x, int tile_count_y, const uint16_t mesh_region[4])
+{
+    int32_t parameters[4] = { tile_count_x, tile_count_y, TileGrid::CHUNK_SIZE, (int32_t) VERSION };
+    
+    uint64_t key = hash(&content_hash, sizeof(content_hash), HASH_SEED);
+    key = hash(parameters, sizeof(parameters), key);
+    key = hash(mesh_region, 4 * sizeof(uint16_t), key);
+    
+    // Zero is reserved for "no derived data"
+    return key == 0 ? 1 : key;
+}
+
+void LevelFile::pack_region(glm::vec4 region, uint16_t packed[4])
+{
+    // Rounded the same way Map rounds its texture coordinates, so a region round-trips exactly
+    packed[0] = (uint16_t) lroundf(region.x * 65535.0f);
+    packed[1] = (uint16_t) lroundf(region.y * 65535.0f);
+    packed[2] = (uint16_t) lroundf(region.z * 65535.0f);
+    packed[3] = (uint16_t) lroundf(region.w * 65535.0f);
+}
+
+std::shared_ptr<LevelFile> LevelFile::open(const char *filepath)
+{
+    std::shared_ptr<LevelFile> level = std::make_shared<LevelFile>();
+    
+    if (!level->m_file.open(filepath))
+    {
+        LOG("Unable to open level. Make sure the path is correct.");
+        return nullptr;
+    }
+    
+    if (!level->validate())
+    {
+        LOG("Level file is corrupt or from an unsupported version.");
+        return nullptr;
+    }
+    
+    return level;
+}
+
+// Whether count elements of element_size bytes fit between offset and end, written so that nothing overflows
+static bool fits(uint64_t offset, uint64_t count, uint64_t element_size, uint64_t end)
+{
+    return offset <= end && count <= (end - offset) / element_size;
+}
+
+bool LevelFile::validate()
+{
+    const unsigned char *data = m_file.get_data();
+    uint64_t size = m_file.get_size();
+    
+    if (size < sizeof(LevelFileHeader)) return false;
+    
+    m_header = (const LevelFileHeader *) data;
+    
+    if (memcmp(m_header->magic, "PLVL", 4) != 0) return false;
+    if (m_header->version != VERSION)           return false;
+    if (m_header->file_size != size)            return false;
+    if (m_header->width <= 0 || m_header->height <= 0 || m_header->layer_count == 0) return false;
+    
+    uint64_t tile_count = (uint64_t) m_header->width * m_header->height;
+    
+    if (m_header->layers_offset % alignof(uint32_t) != 0 || m_header->spawns_offset % alignof(LevelSpawn) != 0) return false;
+    if (!fits(m_header->layers_offset, tile_count, (uint64_t) m_header->layer_count * sizeof(uint32_t), size)) return false;
+    if (!fits(m_header->spawns_offset, m_header->spawn_count, sizeof(LevelSpawn), size))                        return false;
+    
+    uint64_t layers_size = tile_count * m_header->layer_count * sizeof(uint32_t);
+    uint64_t spawns_size = (uint64_t) m_header->spawn_count * sizeof(LevelSpawn);
+    
+    m_layers = (const unsigned int *) (data + m_header->layers_offset);
+    m_spawns = (const LevelSpawn *)   (data + m_header->spawns_offset);
+    
+    // The only full pass over the file: make sure the source data is what the header says it is
+    uint64_t content_hash = hash(m_layers, layers_size, HASH_SEED);
+    content_hash = hash(m_spawns, spawns_size, content_hash);
+    
+    if (content_hash != m_header->content_hash) return false;
+    
+    // Derived data is optional; anything that doesn't line up just gets rebuilt at runtime
+    m_has_derived_data = validate_derived_data(content_hash);
+    
+    if (!m_has_derived_data)
+    {
+        m_chunks   = NULL;
+        m_vertices = NULL;
+        m_indices  = NULL;
+        m_solidity = NULL;
+    }
+    
+    return true;
+}
+
+bool LevelFile::validate_derived_data(uint64_t content_hash)
+{
+    const unsigned char *data = m_file.get_data();
+    uint64_t size = m_file.get_size();
+    
+    int chunk_count_x = (m_header->width  + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+    int chunk_count_y = (m_header->height + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+    
+    if (m_header->derived_key != derived_key(content_hash, m_header->mesh_tile_count_x, m_header->mesh_tile_count_y,
+                                             m_header->mesh_region)) return false;
+    if (m_header->chunk_size  != TileGrid::CHUNK_SIZE)          return false;
+    if (m_header->chunk_count != chunk_count_x * chunk_count_y) return false;
+    
+    // Step 1: Every section is where its type can be read from, and inside the file. The writer lays the mesh
+    // sections out in order, so each one runs up to the start of the next.
+    if (m_header->chunk_table_offset % alignof(LevelChunkEntry) != 0 || m_header->vertices_offset % alignof(TileVertex) != 0 ||
+        m_header->indices_offset % alignof(uint16_t) != 0 || m_header->solidity_offset % alignof(uint64_t) != 0) return false;
+    
+    if (m_header->vertices_offset > m_header->indices_offset || m_header->indices_offset > m_header->solidity_offset) return false;
+    
+    if (!fits(m_header->chunk_table_offset, (uint64_t) m_header->chunk_count, sizeof(LevelChunkEntry), size)) return false;
+    if (!fits(m_header->solidity_offset, (uint64_t) get_solidity_words_per_row() * m_header->height, sizeof(uint64_t), size)) return false;
+    
+    uint64_t section_vertex_count = (m_header->indices_offset  - m_header->vertices_offset) / sizeof(TileVertex);
+    uint64_t section_index_count  = (m_header->solidity_offset - m_header->indices_offset)  / sizeof(uint16_t);
+    
+    const LevelChunkEntry *chunks   = (const LevelChunkEntry *) (data + m_header->chunk_table_offset);
+    const TileVertex      *vertices = (const TileVertex *)      (data + m_header->vertices_offset);
+    const uint16_t        *indices  = (const uint16_t *)        (data + m_header->indices_offset);
+    
+    // Step 2: Every chunk's mesh is inside those sections, and its indices only name its own vertices. This reads
+    // the index section once, which is small next to the layers the content hash already went over.
+    for (int chunk = 0; chunk < m_header->chunk_count; chunk++)
+    {
+        const LevelChunkEntry &entry = chunks[chunk];
+        
+        if (!fits(entry.first_vertex, entry.vertex_count, 1, section_vertex_count)) return false;
+        if (!fits(entry.first_index,  entry.index_count,  1, section_index_count))  return false;
+        
+        for (uint32_t index = 0; index < entry.index_count; index++)
+        {
+            if (indices[entry.first_index + index] >= entry.vertex_count) return false;
+        }
+    }
+    
+    m_chunks   = chunks;
+    m_vertices = vertices;
+    m_indices  = indices;
+    m_solidity = (const uint64_t *) (data + m_header->solidity_offset);
+    
+    return true;
+}
+
+void LevelFile::read(int x, int y, int w, int h, unsigned int *out) const
+{
+    const unsigned int *tiles = get_layer(0);
+    
+    for (int row = 0; row < h; row++)
+    {
+        memcpy(out + row * w, tiles + (size_t) (y + row) * m_header->width + x, w * sizeof(unsigned int));
+    }
+}
+
+bool const LevelFile::has_chunk_meshes(int tile_count_x, int tile_count_y, glm::vec4 tileset_region) const
+{
+    uint16_t packed[4];
+    pack_region(tileset_region, packed);
+    
+    return m_has_derived_data &&
+           m_header->mesh_tile_count_x == tile_count_x &&
+           m_header->mesh_tile_count_y == tile_count_y &&
+           memcmp(m_header->mesh_region, packed, sizeof(packed)) == 0;
+}
+
+bool const LevelFile::get_chunk_mesh(int chunk_x, int chunk_y, const TileVertex **vertices, int *vertex_count,
+                                     const uint16_t **indices, int *index_count) const
+{
+    if (!m_has_derived_data) return false;
+    
+    int chunk_count_x = (m_header->width + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+    const LevelChunkEntry &entry = m_chunks[chunk_y * chunk_count_x + chunk_x];
+    
+    *vertices     = m_vertices + entry.first_vertex;
+    *vertex_count = (int) entry.vertex_count;
+    *indices      = m_indices + entry.first_index;
+    *index_count  = (int) entry.index_count;
+    
+    return true;
+}
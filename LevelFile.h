@@ -0,0 +1,132 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "TileGrid.h"
+#include "MappedFile.h"
+#include "TileSource.h"
+
+/**
+    One corner of a tile. Positions are in half-tile units relative to the chunk's origin and texture
+    coordinates are normalised 16-bit values, so a vertex is 8 bytes instead of 16. Baked into level files
+    and uploaded by Map as is.
+*/
+struct TileVertex
+{
+    int16_t  x, y;
+    uint16_t u, v;
+};
+
+/**
+    Where an entity starts in a level. Enum fields hold EntityType, AIType and AIState values.
+*/
+struct LevelSpawn
+{
+    uint8_t entity_type;
+    uint8_t ai_type;
+    uint8_t ai_state;
+    uint8_t reserved;
+    
+    float x, y;
+    float speed;
+    float jumping_power;
+    float acceleration_x, acceleration_y;
+};
+
+/**
+    On-disk layout of a .plvl file. Every section offset is from the start of the file and 8-byte aligned.
+    
+    The source sections (tile layers and spawns) are covered by content_hash. The derived sections (per-chunk
+    meshes and the solidity bits) are only trusted when derived_key matches the key recomputed from
+    content_hash and the atlas they were meshed for, so stale caches are ignored rather than rendered.
+*/
+struct LevelFileHeader
+{
+    char     magic[4];
+    uint32_t version;
+    
+    int32_t  width;
+    int32_t  height;
+    uint32_t layer_count;
+    uint32_t spawn_count;
+    
+    uint64_t content_hash;
+    uint64_t derived_key;
+    
+    int32_t  mesh_tile_count_x;
+    int32_t  mesh_tile_count_y;
+    uint16_t mesh_region[4];     // The tileset's u, v, width, height on its texture, normalised 16-bit like TileVertex
+    int32_t  chunk_size;
+    int32_t  chunk_count;
+    
+    uint64_t layers_offset;      // layer_count * width * height uint32 tile indices
+    uint64_t spawns_offset;      // spawn_count LevelSpawn records
+    uint64_t chunk_table_offset; // chunk_count LevelChunkEntry records, chunks in row-major order
+    uint64_t vertices_offset;    // TileVertex
+    uint64_t indices_offset;     // uint16 indices, relative to their chunk's first vertex
+    uint64_t solidity_offset;    // height rows of ceil(width / 64) uint64 words, bit x set when tile x is solid
+    uint64_t file_size;
+};
+
+struct LevelChunkEntry
+{
+    uint32_t first_vertex;
+    uint32_t vertex_count;
+    uint32_t first_index;
+    uint32_t index_count;
+};
+
+/**
+    A memory-mapped .plvl level. Layer 0 is the collision layer and doubles as the Map's TileSource; tiles are
+    read straight out of the mapping, so opening a level costs one mmap plus a checksum pass.
+*/
+class LevelFile : public TileSource {
+private:
+    MappedFile                   m_file;
+    const LevelFileHeader       *m_header   = NULL;
+    const unsigned int          *m_layers   = NULL;
+    const LevelSpawn            *m_spawns   = NULL;
+    const LevelChunkEntry       *m_chunks   = NULL;
+    const TileVertex            *m_vertices = NULL;
+    const uint16_t              *m_indices  = NULL;
+    const uint64_t              *m_solidity = NULL;
+    bool                         m_has_derived_data = false;
+    
+    bool validate();
+    bool validate_derived_data(uint64_t content_hash); // Leaves m_has_derived_data to the caller
+    
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const uint32_t VERSION   = 2;
+    static const uint64_t HASH_SEED = 14695981039346656037ull; // FNV-1a offset basis
+    
+    // ————— METHODS ————— //
+    static std::shared_ptr<LevelFile> open(const char *filepath);
+    static bool write(const char *filepath, int width, int height, const std::vector<const unsigned int *> &layers,
+                      const std::vector<LevelSpawn> &spawns, int tile_count_x, int tile_count_y, glm::vec4 tileset_region);
+    
+    static uint64_t hash(const void *data, size_t size, uint64_t seed);
+    static uint64_t derived_key(uint64_t content_hash, int tile_count_x, int tile_count_y, const uint16_t mesh_region[4]);
+    static void     pack_region(glm::vec4 region, uint16_t packed[4]);
+    
+    void read(int x, int y, int w, int h, unsigned int *out) const override;
+    
+    bool const get_chunk_mesh(int chunk_x, int chunk_y, const TileVertex **vertices, int *vertex_count,
+                              const uint16_t **indices, int *index_count) const;
+    
+    // ————— GETTERS ————— //
+    int const get_width()  const override { return m_header->width;  }
+    int const get_height() const override { return m_header->height; }
+    
+    int                 const get_layer_count() const { return (int) m_header->layer_count; }
+    const unsigned int* const get_layer(int layer) const { return m_layers + (size_t) layer * m_header->width * m_header->height; }
+    
+    int               const get_spawn_count() const { return (int) m_header->spawn_count; }
+    const LevelSpawn* const get_spawns()      const { return m_spawns; }
+    
+    int             const get_solidity_words_per_row() const { return (m_header->width + 63) / 64; }
+    const uint64_t* const get_solidity()               const { return m_has_derived_data ? m_solidity : NULL; }
+    
+    // True when the baked meshes were made for this tileset layout and this region of its texture
+    bool const has_chunk_meshes(int tile_count_x, int tile_count_y, glm::vec4 tileset_region) const;
+};
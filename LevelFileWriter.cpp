@@ -0,0 +1,110 @@
+#include "LevelFile.h"
+#include "Map.h"
+#include <cstring>
+#include <fstream>
+
+// Baking chunk meshes goes through Map's own mesher, so unlike the reader in LevelFile.cpp this half needs
+// the GL headers. Only the level converter links it.
+
+template <typename T>
+static uint64_t append_section(std::vector<unsigned char> &buffer, const T *data, size_t count)
+{
+    // Keep every section 8-byte aligned so the mapped pointers can be used directly
+    buffer.resize((buffer.size() + 7) & ~(size_t) 7, 0);
+    
+    uint64_t offset = buffer.size();
+    const unsigned char *bytes = (const unsigned char *) data;
+    buffer.insert(buffer.end(), bytes, bytes + count * sizeof(T));
+    
+    return offset;
+}
+
+bool LevelFile::write(const char *filepath, int width, int height, const std::vector<const unsigned int *> &layers,
+                      const std::vector<LevelSpawn> &spawns, int tile_count_x, int tile_count_y, glm::vec4 tileset_region)
+{
+    if (layers.empty()) return false;
+    
+    size_t tile_count = (size_t) width * height;
+    
+    std::vector<unsigned int> layer_tiles;
+    for (const unsigned int *layer : layers) layer_tiles.insert(layer_tiles.end(), layer, layer + tile_count);
+    
+    // Step 1: Mesh every chunk of the collision layer exactly the way Map would at runtime
+    MemoryTileSource source(width, height, layers[0]);
+    
+    int chunk_count_x = (width  + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+    int chunk_count_y = (height + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+    
+    std::vector<LevelChunkEntry> chunk_table;
+    std::vector<TileVertex>      vertices;
+    std::vector<GLushort>        indices;
+    
+    for (int chunk_y = 0; chunk_y < chunk_count_y; chunk_y++)
+    {
+        for (int chunk_x = 0; chunk_x < chunk_count_x; chunk_x++)
+        {
+            MapChunk chunk;
+            chunk.m_chunk_x = chunk_x;
+            chunk.m_chunk_y = chunk_y;
+            
+            Map::read_chunk_tiles(source, &chunk);
+            Map::mesh_chunk(&chunk, tile_count_x, tile_count_y, tileset_region);
+            
+            chunk_table.push_back(LevelChunkEntry {
+                (uint32_t) vertices.size(), (uint32_t) chunk.m_vertices.size(),
+                (uint32_t) indices.size(),  (uint32_t) chunk.m_indices.size()
+            });
+            
+            vertices.insert(vertices.end(), chunk.m_vertices.begin(), chunk.m_vertices.end());
+            indices.insert(indices.end(), chunk.m_indices.begin(), chunk.m_indices.end());
+        }
+    }
+    
+    // Step 2: Bit-pack solidity, one row of 64-bit words per tile row
+    int words_per_row = (width + 63) / 64;
+    std::vector<uint64_t> solidity((size_t) words_per_row * height, 0);
+    
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            if (layers[0][(size_t) y * width + x] != 0) solidity[(size_t) y * words_per_row + x / 64] |= 1ull << (x % 64);
+        }
+    }
+    
+    // Step 3: Lay the file out and fill in the header last
+    LevelFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, "PLVL", 4);
+    header.version           = VERSION;
+    header.width             = width;
+    header.height            = height;
+    header.layer_count       = (uint32_t) layers.size();
+    header.spawn_count       = (uint32_t) spawns.size();
+    header.mesh_tile_count_x = tile_count_x;
+    header.mesh_tile_count_y = tile_count_y;
+    pack_region(tileset_region, header.mesh_region);
+    header.chunk_size        = TileGrid::CHUNK_SIZE;
+    header.chunk_count       = (int32_t) chunk_table.size();
+    
+    std::vector<unsigned char> buffer(sizeof(LevelFileHeader), 0);
+    header.layers_offset      = append_section(buffer, layer_tiles.data(), layer_tiles.size());
+    header.spawns_offset      = append_section(buffer, spawns.data(),      spawns.size());
+    header.chunk_table_offset = append_section(buffer, chunk_table.data(), chunk_table.size());
+    header.vertices_offset    = append_section(buffer, vertices.data(),    vertices.size());
+    header.indices_offset     = append_section(buffer, indices.data(),     indices.size());
+    header.solidity_offset    = append_section(buffer, solidity.data(),    solidity.size());
+    header.file_size          = buffer.size();
+    
+    header.content_hash = hash(layer_tiles.data(), layer_tiles.size() * sizeof(unsigned int), HASH_SEED);
+    header.content_hash = hash(spawns.data(), spawns.size() * sizeof(LevelSpawn), header.content_hash);
+    header.derived_key  = derived_key(header.content_hash, tile_count_x, tile_count_y, header.mesh_region);
+    
+    memcpy(buffer.data(), &header, sizeof(header));
+    
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) return false;
+    
+    file.write((const char *) buffer.data(), (std::streamsize) buffer.size());
+    return (bool) file;
+}
@@ -6,8 +6,10 @@ public:
     
     ~Level0();
     
-    void initialise() override;
+    void preload() override;
+    
+    bool initialise() override;
     void update(float delta_time) override;
-    void render(ShaderProgram *program) override;
+    void capture_sprites(std::vector<RenderSprite> *sprites) const override;
 };
 
@@ -1,105 +1,365 @@
 #include "Map.h"
+#include "LevelFile.h"
+#include "WorkerPool.h"
+#include <algorithm>
+#include <cstddef>
 
-Map::Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y)
+Map::Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+         glm::vec4 tileset_region)
 {
     m_width = width;
     m_height = height;
     
     m_level_data = level_data;
     m_texture_id = texture_id;
+    m_tileset_region = tileset_region;
     
     m_tile_size = tile_size;
     m_tile_count_x = tile_count_x;
     m_tile_count_y = tile_count_y;
     
+    m_source = std::make_shared<MemoryTileSource>(width, height, level_data);
+    
+    build();
+}
+
+Map::Map(std::shared_ptr<TileSource> source, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+         glm::vec4 tileset_region)
+{
+    m_width = source->get_width();
+    m_height = source->get_height();
+    
+    // Nothing is resident up front; tiles are pulled from the source one chunk at a time
+    m_level_data = NULL;
+    m_texture_id = texture_id;
+    m_tileset_region = tileset_region;
+    
+    m_tile_size = tile_size;
+    m_tile_count_x = tile_count_x;
+    m_tile_count_y = tile_count_y;
+    
+    m_source = source;
+    
+    build();
+}
+
+Map::Map(std::shared_ptr<LevelFile> level, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+         glm::vec4 tileset_region)
+{
+    m_width = level->get_width();
+    m_height = level->get_height();
+    
+    // The collision layer is read straight out of the mapping
+    m_level_data = level->get_layer(0);
+    m_texture_id = texture_id;
+    m_tileset_region = tileset_region;
+    
+    m_tile_size = tile_size;
+    m_tile_count_x = tile_count_x;
+    m_tile_count_y = tile_count_y;
+    
+    m_source = level;
+    if (level->has_chunk_meshes(tile_count_x, tile_count_y, tileset_region)) m_level_file = level;
+    
+    // NULL unless the file's derived data checked out
+    m_baked_solidity = level->get_solidity();
+    
     build();
 }
 
+Map::~Map()
+{
+    for (auto &entry : m_chunks) evict(entry.second.get());
+}
+
+static GLushort to_unorm16(float value)
+{
+    return (GLushort) lroundf(value * 65535.0f);
+}
+
 void Map::build()
 {
-    for(int y = 0; y < m_height; y++)
+    for (auto &entry : m_chunks) evict(entry.second.get());
+    m_chunks.clear();
+    m_pending.clear();
+    
+    // Jobs still in flight keep the old queue alive and their results are simply dropped
+    m_queue = std::make_shared<ChunkQueue>();
+    
+    m_chunk_count_x = (m_width  + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunk_count_y = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    
+    build_grid();
+}
+
+void Map::read_chunk_tiles(const TileSource &source, MapChunk *chunk)
+{
+    int first_x = chunk->m_chunk_x * CHUNK_SIZE;
+    int first_y = chunk->m_chunk_y * CHUNK_SIZE;
+    
+    // Chunks on the right and bottom edges may hang off the level; those tiles stay empty
+    int width  = std::min(CHUNK_SIZE, source.get_width()  - first_x);
+    int height = std::min(CHUNK_SIZE, source.get_height() - first_y);
+    
+    chunk->m_tiles.assign(CHUNK_SIZE * CHUNK_SIZE, 0);
+    
+    for (int row = 0; row < height; row++)
+    {
+        source.read(first_x, first_y + row, width, 1, &chunk->m_tiles[row * CHUNK_SIZE]);
+    }
+}
+
+void Map::mesh_chunk(MapChunk *chunk, int tile_count_x, int tile_count_y, glm::vec4 tileset_region)
+{
+    chunk->m_vertices.clear();
+    chunk->m_indices.clear();
+    
+    float tile_width = tileset_region.z / (float) tile_count_x;
+    float tile_height = tileset_region.w / (float) tile_count_y;
+    
+    for(int y = 0; y < CHUNK_SIZE; y++)
     {
-        for(int x = 0; x < m_width; x++) {
-            int tile = m_level_data[y * m_width + x];
+        for(int x = 0; x < CHUNK_SIZE; x++) {
+            int tile = chunk->m_tiles[y * CHUNK_SIZE + x];
             
             if (tile == 0) continue;
             
-            float u = (float) (tile % m_tile_count_x) / (float) m_tile_count_x;
-            float v = (float) (tile / m_tile_count_x) / (float) m_tile_count_y;
+            float u = tileset_region.x + (float) (tile % tile_count_x) * tile_width;
+            float v = tileset_region.y + (float) (tile / tile_count_x) * tile_height;
+            
+            // Tile centres sit on whole tile coordinates, so every corner is a whole number of half-tiles
+            GLshort left   = (GLshort) (2 * x - 1),
+                    right  = (GLshort) (2 * x + 1),
+                    top    = (GLshort) (-2 * y + 1),
+                    bottom = (GLshort) (-2 * y - 1);
             
-            float tile_width = 1.0f/ (float) m_tile_count_x;
-            float tile_height = 1.0f/ (float) m_tile_count_y;
+            GLushort u_left   = to_unorm16(u),
+                     u_right  = to_unorm16(u + tile_width),
+                     v_top    = to_unorm16(v),
+                     v_bottom = to_unorm16(v + tile_height);
             
-            float x_offset = -(m_tile_size / 2); // From center of tile
-            float y_offset = (m_tile_size / 2); // From center of tile
+            // A full chunk is at most 4096 vertices, so 16-bit indices always suffice
+            GLushort first = (GLushort) chunk->m_vertices.size();
             
-            this->m_vertices.insert(m_vertices.end(), {
-                x_offset + (m_tile_size * x), y_offset + -m_tile_size * y,
-                x_offset + (m_tile_size * x), y_offset + (-m_tile_size * y) - m_tile_size,
-                x_offset + (m_tile_size * x) + m_tile_size, y_offset + (-m_tile_size * y) - m_tile_size,
-                x_offset + (m_tile_size * x), y_offset + -m_tile_size * y,
-                x_offset + (m_tile_size * x) + m_tile_size, y_offset + (-m_tile_size * y) - m_tile_size,
-                x_offset + (m_tile_size * x) + m_tile_size, y_offset + -m_tile_size * y
+            chunk->m_vertices.insert(chunk->m_vertices.end(), {
+                { left,  top,    u_left,  v_top    },
+                { left,  bottom, u_left,  v_bottom },
+                { right, bottom, u_right, v_bottom },
+                { right, top,    u_right, v_top    }
             });
             
-            this->m_texture_coordinates.insert(m_texture_coordinates.end(), {
-                u, v,
-                u, v + (tile_height),
-                u + tile_width, v + (tile_height),
-                u, v,
-                u + tile_width, v + (tile_height),
-                u + tile_width, v
+            chunk->m_indices.insert(chunk->m_indices.end(), {
+                first, (GLushort) (first + 1), (GLushort) (first + 2),
+                first, (GLushort) (first + 2), (GLushort) (first + 3)
             });
         }
     }
+}
+
+MapChunk *Map::load_chunk(int chunk_x, int chunk_y)
+{
+    std::unique_ptr<MapChunk> chunk(new MapChunk());
+    chunk->m_chunk_x = chunk_x;
+    chunk->m_chunk_y = chunk_y;
     
-    m_left_bound   = 0 - (m_tile_size / 2);
-    m_right_bound  = (m_tile_size * m_width) - (m_tile_size / 2);
-    m_top_bound    = 0 + (m_tile_size / 2);
-    m_bottom_bound = -(m_tile_size * m_height) + (m_tile_size / 2);
+    read_chunk_tiles(*m_source, chunk.get());
+    
+    MapChunk *loaded = chunk.get();
+    m_chunks[chunk_key(chunk_x, chunk_y)] = std::move(chunk);
+    
+    return loaded;
 }
 
-void Map::render(ShaderProgram *program)
+void Map::upload(MapChunk *chunk)
 {
-    glm::mat4 model_matrix = glm::mat4(1.0f);
-    program->SetModelMatrix(model_matrix);
+    upload(chunk, chunk->m_vertices.data(), (int) chunk->m_vertices.size(), chunk->m_indices.data(), (int) chunk->m_indices.size());
     
-    glUseProgram(program->programID);
+    // The GPU owns the mesh from here on
+    std::vector<TileVertex>().swap(chunk->m_vertices);
+    std::vector<GLushort>().swap(chunk->m_indices);
+}
+
+void Map::upload(MapChunk *chunk, const TileVertex *vertices, int vertex_count, const GLushort *indices, int index_count)
+{
+    GLStatsScope scope(SUBSYSTEM_MAP);
     
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, m_vertices.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, m_texture_coordinates.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
+    chunk->m_index_count = (GLsizei) index_count;
     
-    glBindTexture(GL_TEXTURE_2D, m_texture_id);
+    if (index_count == 0) return;
+    
+    glGenBuffers(1, &chunk->m_vertex_buffer_id);
+    glGenBuffers(1, &chunk->m_index_buffer_id);
+    
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, chunk->m_vertex_buffer_id);
+    GLStats::buffer_data(GL_ARRAY_BUFFER, vertex_count * sizeof(TileVertex), vertices, GL_STATIC_DRAW);
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, 0);
+    
+    GLStats::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, chunk->m_index_buffer_id);
+    GLStats::buffer_data(GL_ELEMENT_ARRAY_BUFFER, index_count * sizeof(GLushort), indices, GL_STATIC_DRAW);
+    GLStats::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+}
+
+void Map::evict(MapChunk *chunk)
+{
+    if (chunk->m_vertex_buffer_id != 0) glDeleteBuffers(1, &chunk->m_vertex_buffer_id);
+    if (chunk->m_index_buffer_id  != 0) glDeleteBuffers(1, &chunk->m_index_buffer_id);
+    
+    chunk->m_vertex_buffer_id = 0;
+    chunk->m_index_buffer_id  = 0;
+}
+
+void Map::collect_ready_chunks()
+{
+    std::vector<std::unique_ptr<MapChunk>> ready;
+    {
+        std::lock_guard<std::mutex> lock(m_queue->m_mutex);
+        ready.swap(m_queue->m_ready);
+    }
     
-    glDrawArrays(GL_TRIANGLES, 0, (int) m_vertices.size() / 2);
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    for (std::unique_ptr<MapChunk> &chunk : ready)
+    {
+        long long key = chunk_key(chunk->m_chunk_x, chunk->m_chunk_y);
+        m_pending.erase(key);
+        
+        // A chunk that came into view before its worker finished was meshed on the spot; drop this copy
+        if (m_chunks.count(key) != 0) continue;
+        
+        upload(chunk.get());
+        m_chunks[key] = std::move(chunk);
+    }
 }
 
-bool Map::is_solid(glm::vec3 position, float *penetration_x, float *penetration_y)
+void Map::stream(glm::vec3 camera_position, float half_view_width, float half_view_height)
 {
-    *penetration_x = 0;
-    *penetration_y = 0;
+    collect_ready_chunks();
     
-    if (position.x < m_left_bound || position.x > m_right_bound) return false;
-    if (position.y > m_top_bound || position.y < m_bottom_bound) return false;
+    // Step 1: Find the chunks under the view. Rows count up as Y goes down.
+    float half_tile = m_tile_size / 2;
     
-    int tile_x = floor((position.x + (m_tile_size / 2)) / m_tile_size);
-    int tile_y = -(ceil(position.y - (m_tile_size / 2))) / m_tile_size; // Our array counts up as Y goes down.
+    int first_tile_x = (int) floor((camera_position.x - half_view_width  + half_tile) / m_tile_size);
+    int last_tile_x  = (int) floor((camera_position.x + half_view_width  + half_tile) / m_tile_size);
+    int first_tile_y = (int) floor((-camera_position.y - half_view_height + half_tile) / m_tile_size);
+    int last_tile_y  = (int) floor((-camera_position.y + half_view_height + half_tile) / m_tile_size);
     
-    if (tile_x < 0 || tile_x >= m_width) return false;
-    if (tile_y < 0 || tile_y >= m_height) return false;
+    int visible_left   = std::max(0, first_tile_x) / CHUNK_SIZE,
+        visible_right  = std::min(m_width  - 1, last_tile_x) / CHUNK_SIZE,
+        visible_top    = std::max(0, first_tile_y) / CHUNK_SIZE,
+        visible_bottom = std::min(m_height - 1, last_tile_y) / CHUNK_SIZE;
     
-    int tile = m_level_data[tile_y * m_width + tile_x];
-    if (tile == 0) return false;
+    int wanted_left   = std::max(0, visible_left - STREAM_MARGIN),
+        wanted_right  = std::min(m_chunk_count_x - 1, visible_right + STREAM_MARGIN),
+        wanted_top    = std::max(0, visible_top - STREAM_MARGIN),
+        wanted_bottom = std::min(m_chunk_count_y - 1, visible_bottom + STREAM_MARGIN);
+    
+    // Step 2: Request every wanted chunk that isn't resident yet. Chunks only enter m_chunks once uploaded.
+    for (int chunk_y = wanted_top; chunk_y <= wanted_bottom; chunk_y++)
+    {
+        for (int chunk_x = wanted_left; chunk_x <= wanted_right; chunk_x++)
+        {
+            long long key = chunk_key(chunk_x, chunk_y);
+            if (m_chunks.count(key) != 0) continue;
+            
+            bool is_visible = chunk_x >= visible_left && chunk_x <= visible_right &&
+                              chunk_y >= visible_top  && chunk_y <= visible_bottom;
+            
+            const TileVertex *baked_vertices;
+            const GLushort   *baked_indices;
+            int baked_vertex_count, baked_index_count;
+            
+            if (m_level_file != nullptr &&
+                m_level_file->get_chunk_mesh(chunk_x, chunk_y, &baked_vertices, &baked_vertex_count, &baked_indices, &baked_index_count))
+            {
+                // Baked levels upload straight from the mapping; there is nothing to mesh
+                MapChunk *chunk = load_chunk(chunk_x, chunk_y);
+                upload(chunk, baked_vertices, baked_vertex_count, baked_indices, baked_index_count);
+            }
+            else if (is_visible)
+            {
+                // Already on screen, so it can't wait for a worker; the margin normally prevents this
+                MapChunk *chunk = load_chunk(chunk_x, chunk_y);
+                mesh_chunk(chunk, m_tile_count_x, m_tile_count_y, m_tileset_region);
+                upload(chunk);
+            }
+            else if (m_pending.insert(key).second)
+            {
+                std::shared_ptr<TileSource> source = m_source;
+                std::shared_ptr<ChunkQueue> queue  = m_queue;
+                int tile_count_x = m_tile_count_x,
+                    tile_count_y = m_tile_count_y;
+                glm::vec4 tileset_region = m_tileset_region;
+                
+                WorkerPool::get_shared().submit([source, queue, chunk_x, chunk_y, tile_count_x, tile_count_y, tileset_region]
+                {
+                    std::unique_ptr<MapChunk> chunk(new MapChunk());
+                    chunk->m_chunk_x = chunk_x;
+                    chunk->m_chunk_y = chunk_y;
+                    
+                    read_chunk_tiles(*source, chunk.get());
+                    mesh_chunk(chunk.get(), tile_count_x, tile_count_y, tileset_region);
+                    
+                    std::lock_guard<std::mutex> lock(queue->m_mutex);
+                    queue->m_ready.push_back(std::move(chunk));
+                });
+            }
+        }
+    }
     
-    float tile_center_x = (tile_x * m_tile_size);
-    float tile_center_y = -(tile_y * m_tile_size);
+    // Step 3: Evict whatever drifted out of range. Collision reads the flag grids, so it never needs a chunk.
+    for (auto entry = m_chunks.begin(); entry != m_chunks.end();)
+    {
+        MapChunk *chunk = entry->second.get();
+        
+        bool is_wanted = chunk->m_chunk_x >= wanted_left && chunk->m_chunk_x <= wanted_right &&
+                         chunk->m_chunk_y >= wanted_top  && chunk->m_chunk_y <= wanted_bottom;
+        
+        if (!is_wanted)
+        {
+            evict(chunk);
+            entry = m_chunks.erase(entry);
+            continue;
+        }
+        
+        ++entry;
+    }
+}
+
+void Map::render(ShaderProgram *program)
+{
+    GLStatsScope scope(SUBSYSTEM_MAP);
+    
+    if (m_texture_id == 0) return; // The tileset failed to load
+    
+    GLStats::use_program(program->programID);
+    GLStats::bind_texture(GL_TEXTURE_2D, m_texture_id);
+    
+    GLStats::enable_attribute(program->positionAttribute);
+    GLStats::enable_attribute(program->texCoordAttribute);
+    
+    for (auto &entry : m_chunks)
+    {
+        MapChunk *chunk = entry.second.get();
+        if (chunk->m_index_count == 0) continue;
+        
+        // Vertices are stored in half-tile units from the chunk's first tile
+        glm::vec3 origin = glm::vec3(chunk->m_chunk_x * CHUNK_SIZE * m_tile_size, -chunk->m_chunk_y * CHUNK_SIZE * m_tile_size, 0.0f);
+        
+        glm::mat4 model_matrix = glm::mat4(1.0f);
+        model_matrix = glm::translate(model_matrix, origin);
+        model_matrix = glm::scale(model_matrix, glm::vec3(m_tile_size / 2.0f, m_tile_size / 2.0f, 1.0f));
+        program->SetModelMatrix(model_matrix);
+        
+        GLStats::bind_buffer(GL_ARRAY_BUFFER, chunk->m_vertex_buffer_id);
+        GLStats::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, chunk->m_index_buffer_id);
+        
+        glVertexAttribPointer(program->positionAttribute, 2, GL_SHORT, false, sizeof(TileVertex), (void *) offsetof(TileVertex, x));
+        glVertexAttribPointer(program->texCoordAttribute, 2, GL_UNSIGNED_SHORT, true, sizeof(TileVertex), (void *) offsetof(TileVertex, u));
+        
+        GLStats::draw_elements(GL_TRIANGLES, chunk->m_index_count, GL_UNSIGNED_SHORT, (void *) 0);
+    }
     
-    *penetration_x = (m_tile_size / 2) - fabs(position.x - tile_center_x);
-    *penetration_y = (m_tile_size / 2) - fabs(position.y - tile_center_y);
+    GLStats::disable_attribute(program->positionAttribute);
+    GLStats::disable_attribute(program->texCoordAttribute);
     
-    return true;
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, 0);
+    GLStats::bind_buffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 }
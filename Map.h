@@ -4,6 +4,10 @@
 #include <GL/glew.h>
 #endif
 #define GL_GLEXT_PROTOTYPES 1
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <math.h>
 #include <SDL.h>
@@ -12,48 +16,99 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "GLStats.h"
+#include "TileSource.h"
+#include "TileGrid.h"
+#include "LevelFile.h"
 
-class Map {
-private:
-    int m_width;
-    int m_height;
+/**
+    A CHUNK_SIZE x CHUNK_SIZE block of the level's tiles. The mesh is built off the main thread and uploaded
+    once the chunk comes near the camera.
+*/
+struct MapChunk
+{
+    int m_chunk_x;
+    int m_chunk_y;
+    
+    std::vector<unsigned int> m_tiles;
+    std::vector<TileVertex>   m_vertices;
+    std::vector<GLushort>     m_indices;
+    
+    GLuint  m_vertex_buffer_id = 0;
+    GLuint  m_index_buffer_id  = 0;
+    GLsizei m_index_count      = 0;
+};
+
+/**
+    Meshed chunks coming back from the worker threads. Shared with in-flight jobs so that a Map can be
+    destroyed while they are still running.
+*/
+struct ChunkQueue
+{
+    std::mutex                              m_mutex;
+    std::vector<std::unique_ptr<MapChunk>>  m_ready;
+};
+
+/**
+    A TileGrid that also draws itself, streaming chunk meshes in and out around the camera.
     
-    unsigned int *m_level_data;
-    GLuint        m_texture_id;
+    Two threads share a Map, each with its own half. Everything added here (chunks, meshes, GL buffers, the
+    pending set) belongs to the render thread: only stream(), render() and the destructor touch it, and workers
+    only hand meshes back through the ChunkQueue. The simulation thread only uses the TileGrid half, and it
+    reads that half without locking. The flag grids therefore must not change once the map is built.
+*/
+class Map : public TileGrid {
+private:
+    GLuint    m_texture_id;
+    glm::vec4 m_tileset_region; // Where the tileset sits on the texture: all of it, or its part of an atlas page
     
-    float m_tile_size;
     int   m_tile_count_x;
     int   m_tile_count_y;
     
-    std::vector<float> m_vertices;
-    std::vector<float> m_texture_coordinates;
+    // ————— STREAMING ————— //
+    std::shared_ptr<ChunkQueue> m_queue;
+    std::shared_ptr<LevelFile>  m_level_file; // Only set when its baked chunk meshes match this atlas
     
-    float m_left_bound, m_right_bound, m_top_bound, m_bottom_bound;
+    int m_chunk_count_x;
+    int m_chunk_count_y;
+    
+    std::unordered_map<long long, std::unique_ptr<MapChunk>> m_chunks;
+    std::unordered_set<long long>                            m_pending;
+    
+    long long const chunk_key(int chunk_x, int chunk_y) const { return ((long long) chunk_y << 32) | (unsigned int) chunk_x; }
+    
+    MapChunk *load_chunk(int chunk_x, int chunk_y);
+    void upload(MapChunk *chunk);
+    void upload(MapChunk *chunk, const TileVertex *vertices, int vertex_count, const GLushort *indices, int index_count);
+    void evict(MapChunk *chunk);
+    void collect_ready_chunks();
     
 public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int STREAM_MARGIN = 1; // Chunks kept loaded beyond the edge of the view
+    
+    // ————— CONSTRUCTORS ————— //
     Map(int width, int height, unsigned int *level_data, GLuint texture_id, float tile_size, int
-    tile_count_x, int tile_count_y);
+    tile_count_x, int tile_count_y, glm::vec4 tileset_region = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    Map(std::shared_ptr<TileSource> source, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+        glm::vec4 tileset_region = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    Map(std::shared_ptr<LevelFile> level, GLuint texture_id, float tile_size, int tile_count_x, int tile_count_y,
+        glm::vec4 tileset_region = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+    ~Map();
     
+    // ————— METHODS ————— //
     void build();
+    void stream(glm::vec3 camera_position, float half_view_width, float half_view_height);
     void render(ShaderProgram *program);
-    bool is_solid(glm::vec3 position, float *penetration_x, float *penetration_y);
     
-    // Getters
-    int const get_width()  const  { return this->m_width;  }
-    int const get_height() const  { return this->m_height; }
-    
-    unsigned int* const get_level_data() const { return this->m_level_data; }
-    GLuint        const get_texture_id() const { return this->m_texture_id; }
+    static void read_chunk_tiles(const TileSource &source, MapChunk *chunk);
+    static void mesh_chunk(MapChunk *chunk, int tile_count_x, int tile_count_y, glm::vec4 tileset_region);
     
-    float const get_tile_size() const { return this->m_tile_size; }
-    int const get_tile_count_x() const { return this->m_tile_count_x; }
-    int const get_tile_count_y() const { return this->m_tile_count_y; }
-    
-    std::vector<float> const get_vertices()            const { return this->m_vertices;             }
-    std::vector<float> const get_texture_coordinates() const { return this-> m_texture_coordinates; }
+    // Getters
+    GLuint    const get_texture_id()     const { return this->m_texture_id;     }
+    glm::vec4 const get_tileset_region() const { return this->m_tileset_region; }
+    int    const get_tile_count_x() const { return this->m_tile_count_x; }
+    int    const get_tile_count_y() const { return this->m_tile_count_y; }
     
-    float const get_left_bound()   const { return this->m_left_bound;   }
-    float const get_right_bound()  const { return this->m_right_bound;  }
-    float const get_top_bound()    const { return this->m_top_bound;    }
-    float const get_bottom_bound() const { return this->m_bottom_bound; }
+    int const get_resident_chunk_count() const { return (int) this->m_chunks.size(); }
 };
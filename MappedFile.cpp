@@ -0,0 +1,97 @@
+#include "MappedFile.h"
+
+#ifdef _WINDOWS
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WINDOWS
+
+bool MappedFile::open(const char *filepath)
+{
+    close();
+    
+    HANDLE file = CreateFileA(filepath, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+    
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        CloseHandle(file);
+        return false;
+    }
+    
+    m_file_handle    = file;
+    m_mapping_handle = mapping;
+    m_data = (const unsigned char *) MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    m_size = (size_t) size.QuadPart;
+    
+    if (m_data == NULL) close();
+    return m_data != NULL;
+}
+
+void MappedFile::close()
+{
+    if (m_data != NULL)           UnmapViewOfFile(m_data);
+    if (m_mapping_handle != NULL) CloseHandle(m_mapping_handle);
+    if (m_file_handle != NULL)    CloseHandle(m_file_handle);
+    
+    m_data           = NULL;
+    m_size           = 0;
+    m_mapping_handle = NULL;
+    m_file_handle    = NULL;
+}
+
+#else
+
+bool MappedFile::open(const char *filepath)
+{
+    close();
+    
+    int file = ::open(filepath, O_RDONLY);
+    if (file < 0) return false;
+    
+    struct stat status;
+    if (fstat(file, &status) != 0 || status.st_size == 0)
+    {
+        ::close(file);
+        return false;
+    }
+    
+    void *data = mmap(NULL, (size_t) status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    
+    // The mapping keeps the file alive on its own
+    ::close(file);
+    
+    if (data == MAP_FAILED) return false;
+    
+    m_data = (const unsigned char *) data;
+    m_size = (size_t) status.st_size;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (m_data != NULL) munmap((void *) m_data, m_size);
+    
+    m_data = NULL;
+    m_size = 0;
+}
+
+#endif
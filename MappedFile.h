@@ -0,0 +1,33 @@
+#pragma once
+#include <cstddef>
+
+/**
+    A read-only memory mapping of a whole file. The bytes stay valid until the MappedFile is closed or destroyed.
+*/
+class MappedFile {
+private:
+    const unsigned char *m_data = NULL;
+    size_t               m_size = 0;
+    
+#ifdef _WINDOWS
+    void *m_file_handle    = NULL;
+    void *m_mapping_handle = NULL;
+#endif
+    
+public:
+    // ————— CONSTRUCTOR ————— //
+    MappedFile() {}
+    ~MappedFile();
+    
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    
+    // ————— METHODS ————— //
+    bool open(const char *filepath);
+    void close();
+    
+    // ————— GETTERS ————— //
+    const unsigned char* const get_data() const { return m_data;         }
+    size_t               const get_size() const { return m_size;         }
+    bool                 const is_open()  const { return m_data != NULL; }
+};
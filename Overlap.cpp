@@ -0,0 +1,85 @@
+#include "Overlap.h"
+#include <cmath>
+
+#if defined(__AVX__)
+#define OVERLAP_AVX 1
+#include <immintrin.h>
+#elif defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define OVERLAP_SSE 1
+#include <xmmintrin.h>
+#endif
+
+int Overlap::one_vs_many(float x, float y, float width, float height, const BoxSpan &boxes, int *indices)
+{
+    int hit_count = 0;
+    int i = 0;
+
+#if defined(OVERLAP_AVX)
+    __m256 centre_x   = _mm256_set1_ps(x),
+           centre_y   = _mm256_set1_ps(y),
+           own_width  = _mm256_set1_ps(width),
+           own_height = _mm256_set1_ps(height),
+           half       = _mm256_set1_ps(0.5f),
+           sign_bit   = _mm256_set1_ps(-0.0f);
+
+    for (; i + 8 <= boxes.count; i += 8)
+    {
+        __m256 x_distance = _mm256_andnot_ps(sign_bit, _mm256_sub_ps(centre_x, _mm256_loadu_ps(boxes.x + i)));
+        __m256 y_distance = _mm256_andnot_ps(sign_bit, _mm256_sub_ps(centre_y, _mm256_loadu_ps(boxes.y + i)));
+        __m256 x_reach    = _mm256_mul_ps(half, _mm256_add_ps(own_width,  _mm256_loadu_ps(boxes.width  + i)));
+        __m256 y_reach    = _mm256_mul_ps(half, _mm256_add_ps(own_height, _mm256_loadu_ps(boxes.height + i)));
+
+        int mask = _mm256_movemask_ps(_mm256_and_ps(_mm256_cmp_ps(x_distance, x_reach, _CMP_LT_OQ),
+                                                    _mm256_cmp_ps(y_distance, y_reach, _CMP_LT_OQ)));
+        for (; mask != 0; mask &= mask - 1)
+        {
+            int lane = 0;
+            while (!(mask & (1 << lane))) lane++;
+            indices[hit_count++] = i + lane;
+        }
+    }
+#elif defined(OVERLAP_SSE)
+    __m128 centre_x   = _mm_set1_ps(x),
+           centre_y   = _mm_set1_ps(y),
+           own_width  = _mm_set1_ps(width),
+           own_height = _mm_set1_ps(height),
+           half       = _mm_set1_ps(0.5f),
+           sign_bit   = _mm_set1_ps(-0.0f);
+
+    for (; i + 4 <= boxes.count; i += 4)
+    {
+        __m128 x_distance = _mm_andnot_ps(sign_bit, _mm_sub_ps(centre_x, _mm_loadu_ps(boxes.x + i)));
+        __m128 y_distance = _mm_andnot_ps(sign_bit, _mm_sub_ps(centre_y, _mm_loadu_ps(boxes.y + i)));
+        __m128 x_reach    = _mm_mul_ps(half, _mm_add_ps(own_width,  _mm_loadu_ps(boxes.width  + i)));
+        __m128 y_reach    = _mm_mul_ps(half, _mm_add_ps(own_height, _mm_loadu_ps(boxes.height + i)));
+
+        int mask = _mm_movemask_ps(_mm_and_ps(_mm_cmplt_ps(x_distance, x_reach), _mm_cmplt_ps(y_distance, y_reach)));
+        if (mask & 1) indices[hit_count++] = i;
+        if (mask & 2) indices[hit_count++] = i + 1;
+        if (mask & 4) indices[hit_count++] = i + 2;
+        if (mask & 8) indices[hit_count++] = i + 3;
+    }
+#endif
+
+    for (; i < boxes.count; i++)
+    {
+        float x_distance = fabs(x - boxes.x[i]) - ((width  + boxes.width[i])  / 2.0f);
+        float y_distance = fabs(y - boxes.y[i]) - ((height + boxes.height[i]) / 2.0f);
+
+        if (x_distance < 0.0f && y_distance < 0.0f) indices[hit_count++] = i;
+    }
+
+    return hit_count;
+}
+
+void Overlap::many_vs_many(const BoxSpan &first, const BoxSpan &second, std::vector<OverlapPair> *pairs)
+{
+    pairs->clear();
+
+    std::vector<int> indices(second.count);
+    for (int a = 0; a < first.count; a++)
+    {
+        int hit_count = one_vs_many(first.x[a], first.y[a], first.width[a], first.height[a], second, indices.data());
+        for (int j = 0; j < hit_count; j++) pairs->push_back(OverlapPair { a, indices[j] });
+    }
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <vector>
+
+/**
+    A set of axis-aligned boxes laid out one field per array (centres and full extents), e.g. straight out
+    of an EntityPool or gathered from a broadphase query.
+*/
+struct BoxSpan
+{
+    const float *x;
+    const float *y;
+    const float *width;
+    const float *height;
+    int          count;
+};
+
+struct OverlapPair
+{
+    int a;
+    int b;
+};
+
+/**
+    Batched narrowphase. Uses the same test as Entity::check_collision (touching edges don't count), eight or
+    four boxes at a time with AVX or SSE and a scalar loop for the rest.
+*/
+class Overlap {
+public:
+    // Writes the index of every box in `boxes` that overlaps the given one into `indices` (room for
+    // boxes.count entries) and returns how many there were
+    static int one_vs_many(float x, float y, float width, float height, const BoxSpan &boxes, int *indices);
+
+    // Every overlapping (a, b) pair, a indexing `first` and b indexing `second`
+    static void many_vs_many(const BoxSpan &first, const BoxSpan &second, std::vector<OverlapPair> *pairs);
+};
@@ -0,0 +1,144 @@
+#include "Profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+ProfileRing                Profiler::s_ring;
+std::atomic<uint32_t>      Profiler::s_frame(0);
+uint64_t                   Profiler::s_frame_start_ns = 0;
+std::vector<FrameProfile>  Profiler::s_session;
+std::vector<ProfileSample> Profiler::s_drained;
+
+static const char *PHASE_NAMES[PHASE_COUNT] = { "input", "step", "effects", "render", "swap", "wait" };
+
+// ————— RING ————— //
+ProfileRing::ProfileRing() : m_write_index(0)
+{
+    for (Slot &slot : m_slots) slot.m_sequence.store(0, std::memory_order_relaxed);
+}
+
+void ProfileRing::push(const ProfileSample &sample)
+{
+    uint64_t index = m_write_index.fetch_add(1, std::memory_order_relaxed);
+    Slot    &slot  = m_slots[index & (CAPACITY - 1)];
+
+    // Zero marks the slot as mid-write; index + 1 says which push it holds once it's done
+    slot.m_sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.m_sample = sample;
+    slot.m_sequence.store(index + 1, std::memory_order_release);
+}
+
+void ProfileRing::drain(std::vector<ProfileSample> *samples)
+{
+    samples->clear();
+
+    uint64_t write_index = m_write_index.load(std::memory_order_acquire);
+
+    // Anything more than a lap behind has been overwritten already
+    if (write_index - m_read_index > CAPACITY) m_read_index = write_index - CAPACITY;
+
+    for (; m_read_index < write_index; m_read_index++)
+    {
+        const Slot &slot = m_slots[m_read_index & (CAPACITY - 1)];
+
+        if (slot.m_sequence.load(std::memory_order_acquire) != m_read_index + 1) continue;
+        ProfileSample sample = slot.m_sample;
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.m_sequence.load(std::memory_order_relaxed) != m_read_index + 1) continue;
+
+        samples->push_back(sample);
+    }
+}
+
+// ————— PROFILER ————— //
+uint64_t Profiler::now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void Profiler::record(ProfilePhase phase, uint64_t start_ns, uint64_t end_ns)
+{
+    s_ring.push(ProfileSample { s_frame.load(std::memory_order_relaxed), (uint32_t) phase, start_ns, end_ns - start_ns });
+}
+
+void Profiler::begin_frame()
+{
+    s_frame_start_ns = now_ns();
+}
+
+void Profiler::end_frame()
+{
+    uint32_t frame = s_frame.load(std::memory_order_relaxed);
+
+    FrameProfile profile = {};
+    profile.frame_ns = now_ns() - s_frame_start_ns;
+    s_session.push_back(profile);
+
+    // Samples pushed late (e.g. by another thread) still land in the frame they were taken in
+    s_ring.drain(&s_drained);
+    for (const ProfileSample &sample : s_drained)
+    {
+        if (sample.frame > frame || sample.phase >= PHASE_COUNT) continue;
+
+        FrameProfile &owner = s_session[sample.frame];
+        owner.phase_ns[sample.phase] += sample.duration_ns;
+        if (sample.phase == PHASE_STEP) owner.step_count++;
+    }
+
+    s_frame.store(frame + 1, std::memory_order_relaxed);
+}
+
+void Profiler::frame_percentiles(int frame_count, double *p50, double *p99, double *max)
+{
+    frame_count = std::min(frame_count, (int) s_session.size());
+    if (frame_count == 0)
+    {
+        *p50 = *p99 = *max = 0.0;
+        return;
+    }
+
+    std::vector<uint64_t> frame_times;
+    frame_times.reserve(frame_count);
+    for (size_t i = s_session.size() - frame_count; i < s_session.size(); i++) frame_times.push_back(s_session[i].frame_ns);
+
+    std::sort(frame_times.begin(), frame_times.end());
+
+    *p50 = frame_times[(frame_count - 1) * 50 / 100] / 1e6;
+    *p99 = frame_times[(frame_count - 1) * 99 / 100] / 1e6;
+    *max = frame_times.back() / 1e6;
+}
+
+bool Profiler::dump_csv(const char *filepath)
+{
+    std::ofstream file(filepath);
+    if (!file)
+    {
+        LOG("Unable to write profile " << filepath);
+        return false;
+    }
+
+    file << "frame,frame_ms";
+    for (int phase = 0; phase < PHASE_COUNT; phase++) file << ',' << PHASE_NAMES[phase] << "_ms";
+    file << ",steps\n";
+
+    for (size_t frame = 0; frame < s_session.size(); frame++)
+    {
+        const FrameProfile &profile = s_session[frame];
+
+        file << frame << ',' << profile.frame_ns / 1e6;
+        for (int phase = 0; phase < PHASE_COUNT; phase++) file << ',' << profile.phase_ns[phase] / 1e6;
+        file << ',' << profile.step_count << '\n';
+    }
+
+    return (bool) file;
+}
+
+const char *Profiler::get_phase_name(ProfilePhase phase)
+{
+    return PHASE_NAMES[phase];
+}
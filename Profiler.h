@@ -0,0 +1,99 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+enum ProfilePhase { PHASE_INPUT, PHASE_STEP, PHASE_EFFECTS, PHASE_RENDER, PHASE_SWAP, PHASE_WAIT, PHASE_COUNT };
+
+/**
+    One timed stretch of one phase. A frame usually has several PHASE_STEP samples, one per fixed step.
+*/
+struct ProfileSample
+{
+    uint32_t frame;
+    uint32_t phase;
+    uint64_t start_ns;
+    uint64_t duration_ns;
+};
+
+/**
+    Everything recorded for one frame, in nanoseconds. phase_ns sums every sample of that phase.
+*/
+struct FrameProfile
+{
+    uint64_t frame_ns;
+    uint64_t phase_ns[PHASE_COUNT];
+    int      step_count;
+};
+
+/**
+    A fixed-size ring of samples that any thread can push to without blocking. A writer claims a slot with
+    one fetch_add and publishes it by storing the slot's sequence number last; the single reader skips slots
+    that are still being written or were lapped before it got to them.
+*/
+class ProfileRing {
+private:
+    struct Slot
+    {
+        std::atomic<uint64_t> m_sequence;
+        ProfileSample         m_sample;
+    };
+
+    static const int CAPACITY = 1 << 14;
+
+    Slot                  m_slots[CAPACITY];
+    std::atomic<uint64_t> m_write_index;
+    uint64_t              m_read_index = 0;
+
+public:
+    // ————— CONSTRUCTOR ————— //
+    ProfileRing();
+
+    // ————— METHODS ————— //
+    void push(const ProfileSample &sample);
+
+    // Copies every sample published since the last drain into samples, oldest first. Reader thread only.
+    void drain(std::vector<ProfileSample> *samples);
+};
+
+/**
+    Frame timing for the whole process. The main loop brackets each frame with begin_frame and end_frame and
+    ProfileScopes time the phases in between; every finished frame is kept for the CSV dump on exit.
+*/
+class Profiler {
+private:
+    static ProfileRing                s_ring;
+    static std::atomic<uint32_t>      s_frame;
+    static uint64_t                   s_frame_start_ns;
+    static std::vector<FrameProfile>  s_session;
+    static std::vector<ProfileSample> s_drained;
+
+public:
+    // ————— METHODS ————— //
+    static uint64_t now_ns();
+    static void record(ProfilePhase phase, uint64_t start_ns, uint64_t end_ns);
+
+    static void begin_frame();
+    static void end_frame();
+
+    // Frame-time percentiles over the last frame_count finished frames, in milliseconds
+    static void frame_percentiles(int frame_count, double *p50, double *p99, double *max);
+    static bool dump_csv(const char *filepath);
+
+    // ————— GETTERS ————— //
+    static const std::vector<FrameProfile> &get_session() { return s_session; }
+    static const char *get_phase_name(ProfilePhase phase);
+};
+
+/**
+    Times the enclosing block as one sample of the given phase.
+*/
+class ProfileScope {
+private:
+    ProfilePhase m_phase;
+    uint64_t     m_start_ns;
+
+public:
+    ProfileScope(ProfilePhase phase) : m_phase(phase), m_start_ns(Profiler::now_ns()) {}
+    ~ProfileScope() { Profiler::record(m_phase, m_start_ns, Profiler::now_ns()); }
+};
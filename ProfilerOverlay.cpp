@@ -0,0 +1,153 @@
+#include "ProfilerOverlay.h"
+#include <algorithm>
+#include <cstdio>
+#include <string>
+
+// Screen-space layout, in the same units as the projection (10 x 7.5 across the window)
+static const float PANEL_LEFT   = -4.95f,
+                   PANEL_RIGHT  =  2.85f,
+                   PANEL_BOTTOM =  1.55f,
+                   PANEL_TOP    =  3.70f;
+
+static const float TEXT_LEFT = -4.80f,
+                   TEXT_SIZE =  0.13f;
+
+static const float GRAPH_LEFT      = -4.80f,
+                   GRAPH_BOTTOM    =  1.65f,
+                   GRAPH_HEIGHT    =  1.20f,
+                   GRAPH_WIDTH     =  6.00f,
+                   GRAPH_MAX_MS    = 33.3f,  // Two 60 Hz frames fill the graph; anything slower is clipped
+                   TARGET_FRAME_MS = 16.67f;
+
+static void append_quad(std::vector<float> &vertices, float left, float bottom, float right, float top)
+{
+    vertices.insert(vertices.end(), {
+        left,  bottom, right, bottom, right, top,
+        left,  bottom, right, top,    left,  top
+    });
+}
+
+ProfilerOverlay::ProfilerOverlay(const char *font_filepath, glm::mat4 projection_matrix) : m_text(font_filepath)
+{
+    m_graph_program.Load("shaders/vertex.glsl", "shaders/fragment.glsl");
+    m_graph_program.SetProjectionMatrix(projection_matrix);
+    m_graph_program.SetViewMatrix(glm::mat4(1.0f));
+    m_graph_program.SetModelMatrix(glm::mat4(1.0f));
+
+    m_summary_label = m_text.add_label("", TEXT_SIZE, 0.0f, glm::vec3(TEXT_LEFT, 3.55f, 0.0f));
+    m_step_label    = m_text.add_label("", TEXT_SIZE, 0.0f, glm::vec3(TEXT_LEFT, 3.40f, 0.0f));
+    m_phase_label   = m_text.add_label("", TEXT_SIZE, 0.0f, glm::vec3(TEXT_LEFT, 3.25f, 0.0f));
+    m_gl_label      = m_text.add_label("", TEXT_SIZE, 0.0f, glm::vec3(TEXT_LEFT, 3.10f, 0.0f));
+
+    m_text.set_visible(m_summary_label, true);
+    m_text.set_visible(m_step_label,    true);
+    m_text.set_visible(m_phase_label,   true);
+    m_text.set_visible(m_gl_label,      true);
+}
+
+void ProfilerOverlay::refresh_labels()
+{
+    const std::vector<FrameProfile> &session = Profiler::get_session();
+    if (session.empty()) return;
+
+    double p50, p99, max;
+    Profiler::frame_percentiles(HISTORY_SIZE, &p50, &p99, &max);
+
+    // Phases and steps are averaged over the frames since the last refresh
+    int    frame_count = std::min((int) session.size(), REFRESH_FRAMES);
+    double phase_ms[PHASE_COUNT] = {};
+    int    step_count = 0;
+
+    for (size_t i = session.size() - frame_count; i < session.size(); i++)
+    {
+        for (int phase = 0; phase < PHASE_COUNT; phase++) phase_ms[phase] += session[i].phase_ns[phase] / 1e6;
+        step_count += session[i].step_count;
+    }
+
+    char line[128];
+
+    snprintf(line, sizeof(line), "frame p50 %.2f p99 %.2f max %.2f ms", p50, p99, max);
+    m_text.set_text(m_summary_label, line);
+
+    snprintf(line, sizeof(line), "fixed steps %d (last) %.2f (avg)", session.back().step_count, (double) step_count / frame_count);
+    m_text.set_text(m_step_label, line);
+
+    std::string phases;
+    for (int phase = 0; phase < PHASE_COUNT; phase++)
+    {
+        snprintf(line, sizeof(line), "%s%s %.2f", phase == 0 ? "" : " ", Profiler::get_phase_name((ProfilePhase) phase),
+                 phase_ms[phase] / frame_count);
+        phases += line;
+    }
+    m_text.set_text(m_phase_label, phases);
+
+    uint64_t gl_counts[STAT_COUNT];
+    for (int stat = 0; stat < STAT_COUNT; stat++)
+    {
+        gl_counts[stat] = GLStats::get_last_frame_total((GLStat) stat) - GLStats::get_last_frame(SUBSYSTEM_PROFILER, (GLStat) stat);
+    }
+
+    snprintf(line, sizeof(line), "gl draws %llu prog %llu tex %llu buf %llu attr %llu up %.1fkb dup %llu",
+             (unsigned long long) gl_counts[STAT_DRAW_CALLS], (unsigned long long) gl_counts[STAT_PROGRAM_SWITCHES],
+             (unsigned long long) gl_counts[STAT_TEXTURE_BINDS], (unsigned long long) gl_counts[STAT_BUFFER_BINDS],
+             (unsigned long long) gl_counts[STAT_ATTRIBUTE_TOGGLES], gl_counts[STAT_UPLOAD_BYTES] / 1024.0,
+             (unsigned long long) gl_counts[STAT_REDUNDANT_BINDS]);
+    m_text.set_text(m_gl_label, line);
+}
+
+void ProfilerOverlay::draw_triangles(const std::vector<float> &vertices, float red, float green, float blue, float alpha)
+{
+    m_graph_program.SetColor(red, green, blue, alpha);
+
+    glVertexAttribPointer(m_graph_program.positionAttribute, 2, GL_FLOAT, false, 0, vertices.data());
+    GLStats::enable_attribute(m_graph_program.positionAttribute);
+    GLStats::draw_arrays(GL_TRIANGLES, 0, (GLsizei) vertices.size() / 2);
+    GLStats::disable_attribute(m_graph_program.positionAttribute);
+}
+
+void ProfilerOverlay::render(ShaderProgram *text_program)
+{
+    GLStatsScope scope(SUBSYSTEM_PROFILER);
+
+    if (!m_is_visible) return;
+
+    if (--m_frames_until_refresh <= 0)
+    {
+        refresh_labels();
+        m_frames_until_refresh = REFRESH_FRAMES;
+    }
+
+    GLStats::use_program(m_graph_program.programID);
+
+    // Step 1: Darken the panel so the numbers read over any level
+    m_bar_vertices.clear();
+    append_quad(m_bar_vertices, PANEL_LEFT, PANEL_BOTTOM, PANEL_RIGHT, PANEL_TOP);
+    draw_triangles(m_bar_vertices, 0.0f, 0.0f, 0.0f, 0.6f);
+
+    // Step 2: One bar per recent frame, oldest on the left
+    const std::vector<FrameProfile> &session = Profiler::get_session();
+    int   frame_count = std::min((int) session.size(), HISTORY_SIZE);
+    float bar_width   = GRAPH_WIDTH / HISTORY_SIZE;
+
+    m_bar_vertices.clear();
+    for (int i = 0; i < frame_count; i++)
+    {
+        float frame_ms = session[session.size() - frame_count + i].frame_ns / 1e6f;
+        float height   = std::min(frame_ms, GRAPH_MAX_MS) / GRAPH_MAX_MS * GRAPH_HEIGHT;
+        float left     = GRAPH_LEFT + (HISTORY_SIZE - frame_count + i) * bar_width;
+
+        append_quad(m_bar_vertices, left, GRAPH_BOTTOM, left + bar_width, GRAPH_BOTTOM + height);
+    }
+    draw_triangles(m_bar_vertices, 0.3f, 0.9f, 0.3f, 1.0f);
+
+    // Step 3: The 60 Hz budget, for scale
+    float target_y = GRAPH_BOTTOM + TARGET_FRAME_MS / GRAPH_MAX_MS * GRAPH_HEIGHT;
+
+    m_bar_vertices.clear();
+    append_quad(m_bar_vertices, GRAPH_LEFT, target_y - 0.005f, GRAPH_LEFT + GRAPH_WIDTH, target_y + 0.005f);
+    draw_triangles(m_bar_vertices, 0.9f, 0.2f, 0.2f, 1.0f);
+
+    // Step 4: The text, through the game's textured program with the camera taken out
+    text_program->SetViewMatrix(glm::mat4(1.0f));
+    m_text.render(text_program);
+}
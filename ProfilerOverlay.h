@@ -0,0 +1,58 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "ShaderProgram.h"
+#include "GLStats.h"
+#include "TextRenderer.h"
+#include "Profiler.h"
+
+/**
+    Draws the Profiler's numbers over the game in screen space: a frame-time graph of the recent frames,
+    p50/p99/max, the fixed steps taken last frame, where the time went by phase and what the last frame asked
+    of GL (leaving out the overlay's own calls). Hidden until toggled.
+*/
+class ProfilerOverlay {
+private:
+    TextRenderer  m_text;
+    ShaderProgram m_graph_program; // Untextured, like the Effects overlay
+
+    int m_summary_label,
+        m_step_label,
+        m_phase_label,
+        m_gl_label;
+
+    bool m_is_visible = false;
+    int  m_frames_until_refresh = 0;
+
+    std::vector<float> m_bar_vertices;
+
+    void refresh_labels();
+    void draw_triangles(const std::vector<float> &vertices, float red, float green, float blue, float alpha);
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int HISTORY_SIZE    = 240; // Frames shown in the graph and covered by the percentiles
+    static const int REFRESH_FRAMES  = 15;  // The numbers only change this often, so they stay readable
+
+    // ————— CONSTRUCTOR ————— //
+    ProfilerOverlay(const char *font_filepath, glm::mat4 projection_matrix);
+
+    // ————— METHODS ————— //
+    void toggle() { m_is_visible = !m_is_visible; m_frames_until_refresh = 0; }
+
+    // Draws with an identity view matrix, so text_program's view has to be set again before its next use
+    void render(ShaderProgram *text_program);
+
+    // ————— GETTERS ————— //
+    bool const is_visible() const { return m_is_visible; }
+};
@@ -0,0 +1,34 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/mat4x4.hpp"
+
+/**
+    One entity as the renderer needs it, copied out of the simulation after a tick: where it was before the tick,
+    where it is now, and which frame of which texture to draw.
+*/
+struct RenderSprite
+{
+    unsigned int texture_id;
+    glm::vec4    uv;
+    glm::vec3    previous_position;
+    glm::vec3    position;
+};
+
+/**
+    Everything one tick left on screen. The simulation thread fills one in after every tick and hands it over
+    whole; the render thread only ever draws from these, never from the scenes' live state.
+*/
+struct RenderSnapshot
+{
+    uint64_t tick;
+    uint64_t tick_end_ns; // The Profiler::now_ns() time this tick's state stands for
+
+    int                       scene_id; // Index into main.cpp's g_levels
+    std::vector<RenderSprite> sprites;
+    glm::vec3                 previous_camera;
+    glm::vec3                 camera;
+    bool                      is_moving; // Whether anything above differs between its previous and current state
+
+    uint64_t visible_labels; // One bit per TextRenderer label id
+};
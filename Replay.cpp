@@ -0,0 +1,82 @@
+#include "Replay.h"
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+static const char REPLAY_MAGIC[4] = { 'P', 'R', 'E', 'P' };
+
+void Replay::record(uint8_t input, uint64_t state_hash)
+{
+    m_inputs.push_back(input);
+    m_hashes.push_back(fold_hash(state_hash));
+}
+
+bool Replay::save(const char *filepath) const
+{
+    ReplayHeader header;
+    memcpy(header.magic, REPLAY_MAGIC, sizeof(header.magic));
+    header.version    = VERSION;
+    header.seed       = m_seed;
+    header.tick_count = (uint32_t) m_inputs.size();
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file)
+    {
+        LOG("Unable to write replay " << filepath);
+        return false;
+    }
+
+    static const char padding[4] = { 0, 0, 0, 0 };
+
+    file.write((const char *) &header, sizeof(header));
+    file.write((const char *) m_inputs.data(), m_inputs.size());
+    file.write(padding, (4 - m_inputs.size() % 4) % 4);
+    file.write((const char *) m_hashes.data(), m_hashes.size() * sizeof(uint32_t));
+
+    return (bool) file;
+}
+
+bool Replay::load(const char *filepath)
+{
+    std::ifstream file(filepath, std::ios::binary | std::ios::ate);
+    std::streamoff file_size = file.tellg();
+    file.seekg(0);
+
+    ReplayHeader header;
+    if (!file.read((char *) &header, sizeof(header)) ||
+        memcmp(header.magic, REPLAY_MAGIC, sizeof(header.magic)) != 0 || header.version != VERSION)
+    {
+        LOG("Unable to read replay " << filepath);
+        return false;
+    }
+
+    // Checked before anything is sized from it, so a corrupt count can't ask for gigabytes. Summed in 64 bits,
+    // which no uint32_t count can overflow.
+    uint64_t expected_size = sizeof(header) + (uint64_t) header.tick_count + (4 - header.tick_count % 4) % 4 +
+                             (uint64_t) header.tick_count * sizeof(uint32_t);
+    if (file_size < 0 || (uint64_t) file_size != expected_size)
+    {
+        LOG("Replay " << filepath << " is " << file_size << " bytes, but its " << header.tick_count << " ticks need " << expected_size);
+        return false;
+    }
+
+    char padding[4];
+
+    m_seed = header.seed;
+    m_inputs.resize(header.tick_count);
+    m_hashes.resize(header.tick_count);
+
+    file.read((char *) m_inputs.data(), m_inputs.size());
+    file.read(padding, (4 - m_inputs.size() % 4) % 4);
+    file.read((char *) m_hashes.data(), m_hashes.size() * sizeof(uint32_t));
+
+    if (!file)
+    {
+        LOG("Replay " << filepath << " is truncated");
+        return false;
+    }
+
+    return true;
+}
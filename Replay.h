@@ -0,0 +1,60 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+
+/**
+    One tick's worth of player input, as bits of a byte. Held keys stay set for every tick they're down;
+    presses (jump, start) are only seen by the first tick after them.
+*/
+enum InputBit
+{
+    INPUT_LEFT  = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_JUMP  = 1 << 2,
+    INPUT_START = 1 << 3
+};
+
+/**
+    On-disk layout of a .prep file: this header, then tick_count input bytes, padded to 4 bytes, then
+    tick_count state hashes.
+*/
+struct ReplayHeader
+{
+    char     magic[4];
+    uint32_t version;
+    uint32_t seed;
+    uint32_t tick_count;
+};
+
+/**
+    A recorded run: the seed it started from, the input of every fixed tick and a hash of the simulation's
+    state after that tick. Feeding the inputs back must reproduce every hash; the first tick that doesn't is
+    where the simulation diverged.
+*/
+class Replay {
+private:
+    uint32_t              m_seed;
+    std::vector<uint8_t>  m_inputs;
+    std::vector<uint32_t> m_hashes;
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const uint32_t VERSION = 1;
+
+    // ————— CONSTRUCTORS ————— //
+    Replay(uint32_t seed = 0) : m_seed(seed) {}
+
+    // ————— METHODS ————— //
+    void record(uint8_t input, uint64_t state_hash);
+    bool save(const char *filepath) const;
+    bool load(const char *filepath);
+
+    // State hashes are folded to 32 bits on disk; plenty to catch a divergence on the tick it happens
+    static uint32_t const fold_hash(uint64_t state_hash) { return (uint32_t) (state_hash ^ (state_hash >> 32)); }
+
+    // ————— GETTERS ————— //
+    uint32_t const get_seed()          const { return m_seed;                }
+    int      const get_tick_count()    const { return (int) m_inputs.size(); }
+    uint8_t  const get_input(int tick) const { return m_inputs[tick];        }
+    uint32_t const get_hash(int tick)  const { return m_hashes[tick];        }
+};
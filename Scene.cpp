@@ -1 +1,46 @@
 #include "Scene.h"
+#include <iostream>
+#define LOG(argument) std::cout << argument << '\n'
+
+std::shared_ptr<LevelFile> Scene::load_map(const char *filepath, const SpriteSheet &tileset, int tile_count_x, int tile_count_y)
+{
+    std::shared_ptr<LevelFile> level = LevelFile::open(filepath);
+    if (level == nullptr)
+    {
+        LOG("Unable to load " << filepath << "; the level can't be played.");
+        return nullptr;
+    }
+    
+    m_state.map_texture = tileset.m_texture;
+    m_state.map         = new Map(level, m_state.map_texture->m_id, 1.0f, tile_count_x, tile_count_y, tileset.m_region);
+    m_state.tiles       = m_state.map;
+    
+    return level;
+}
+
+bool const Scene::is_preloaded() const
+{
+    for (const std::shared_ptr<Texture> &texture : m_preloaded_textures)
+    {
+        if (!texture->m_is_ready) return false;
+    }
+    for (const MusicRequest &music : m_preloaded_music)
+    {
+        if (music.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    }
+    for (const SoundRequest &sound : m_preloaded_sounds)
+    {
+        if (sound.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+    }
+    
+    return true;
+}
+
+void Scene::render(ShaderProgram *program, const std::vector<RenderSprite> &sprites, float alpha)
+{
+    m_state.map->render(program);
+    
+    m_sprite_batch.begin(alpha);
+    m_sprite_batch.add(sprites);
+    m_sprite_batch.render(program);
+}
@@ -15,38 +15,44 @@
 #include "Util.h"
 #include "Entity.h"
 #include "Map.h"
+#include "LevelFile.h"
+#include "AssetCache.h"
+#include "Audio.h"
+#include "SpriteBatch.h"
+#include "World.h"
 
 /**
-    Notice that the game's state is now part of the Scene class, not the main file.
+    A level as the game sees it: a World plus the assets, sprite batch and drawing that go with it.
 */
-struct GameState
-{
-    // ————— GAME OBJECTS ————— //
-    Map *map;
-    Entity *player;
-    Entity *enemies;
+class Scene : public World {
+protected:
+    // Opens the level file and builds m_state.map from it, meshed against tileset. When the file is missing or
+    // fails validation this logs, builds nothing and returns nullptr, and initialise() should return false.
+    std::shared_ptr<LevelFile> load_map(const char *filepath, const SpriteSheet &tileset, int tile_count_x, int tile_count_y);
     
-    // ————— AUDIO ————— //
-    Mix_Music *bgm;
-    Mix_Chunk *jump_sfx;
-    
-    // ————— POINTERS TO OTHER SCENES ————— //
-    int next_scene_id;
-};
-
-class Scene {
 public:
     // ————— ATTRIBUTES ————— //
-    int m_number_of_enemies = 1;
+    SpriteBatch m_sprite_batch;
     
-    GameState m_state;
+    // Requested by preload() so they decode in the background; holding them keeps them resident until
+    // initialise() picks them up from the cache
+    std::vector<std::shared_ptr<Texture>> m_preloaded_textures;
+    std::vector<MusicRequest>             m_preloaded_music;
+    std::vector<SoundRequest>             m_preloaded_sounds;
     
     // ————— METHODS ————— //
-    virtual void initialise() = 0;
+    virtual void preload() {}
+    
+    // Builds the level on its first visit. Returns false, leaving it unbuilt, when its level file can't be loaded.
+    virtual bool initialise() = 0;
     virtual void update(float delta_time) = 0;
-    virtual void render(ShaderProgram *program) = 0;
+    
+    // Simulation thread: appends what this level draws, as it stands after the last step
+    virtual void capture_sprites(std::vector<RenderSprite> *sprites) const = 0;
+    
+    // Render thread: draws the map and sprites captured by capture_sprites. alpha: see SpriteBatch::begin
+    void render(ShaderProgram *program, const std::vector<RenderSprite> &sprites, float alpha);
     
     // ————— GETTERS ————— //
-    GameState const get_state()             const { return m_state;             }
-    int       const get_number_of_enemies() const { return m_number_of_enemies; }
+    bool const is_preloaded() const;
 };
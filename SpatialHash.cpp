@@ -0,0 +1,133 @@
+#include "SpatialHash.h"
+#include "Entity.h"
+#include "Overlap.h"
+#include <algorithm>
+
+SpatialHash::SpatialHash(float cell_size)
+{
+    m_cell_size = cell_size;
+}
+
+void SpatialHash::clear()
+{
+    m_entries.clear();
+    m_max_half_extent = 0.0f;
+}
+
+void SpatialHash::insert(Entity *entity)
+{
+    if (!entity->get_is_active()) return;
+    
+    glm::vec3 position = entity->get_position();
+    m_entries.push_back(Entry { cell_of(position.x), cell_of(position.y), entity });
+    
+    // Entities are filed under their centre only, so queries widen by the largest half-extent seen
+    m_max_half_extent = std::max(m_max_half_extent, std::max(entity->get_width(), entity->get_height()) / 2.0f);
+}
+
+void SpatialHash::insert(Entity *entities, int entity_count)
+{
+    for (int i = 0; i < entity_count; i++) insert(&entities[i]);
+}
+
+void SpatialHash::build()
+{
+    // Step 1: Size the table to roughly two buckets per entity; it only ever grows, so steady state doesn't allocate
+    int bucket_count = 64;
+    while (bucket_count < (int) m_entries.size() * 2) bucket_count *= 2;
+    
+    m_bucket_mask = bucket_count - 1;
+    m_bucket_start.assign(bucket_count + 1, 0);
+    
+    // Step 2: Counting sort the entries by bucket. After the prefix sum each slot holds its bucket's end, and
+    //         filling from the back leaves it holding the bucket's start.
+    for (const Entry &entry : m_entries) m_bucket_start[bucket_of(entry.m_cell_x, entry.m_cell_y)]++;
+    for (int i = 1; i < bucket_count; i++) m_bucket_start[i] += m_bucket_start[i - 1];
+    m_bucket_start[bucket_count] = (int) m_entries.size();
+    
+    m_sorted.resize(m_entries.size());
+    for (const Entry &entry : m_entries) m_sorted[--m_bucket_start[bucket_of(entry.m_cell_x, entry.m_cell_y)]] = entry;
+}
+
+const std::vector<Entity*> &SpatialHash::query(float left, float right, float bottom, float top)
+{
+    m_results.clear();
+    if (m_entries.empty()) return m_results;
+    
+    // Entities may have moved since build(), so allow half a cell of drift on top of their size
+    float margin = m_max_half_extent + m_cell_size / 2.0f;
+    
+    int first_x = cell_of(left - margin),   last_x = cell_of(right + margin),
+        first_y = cell_of(bottom - margin), last_y = cell_of(top + margin);
+    
+    for (int cell_y = first_y; cell_y <= last_y; cell_y++)
+    {
+        for (int cell_x = first_x; cell_x <= last_x; cell_x++)
+        {
+            int bucket = bucket_of(cell_x, cell_y);
+            
+            for (int i = m_bucket_start[bucket]; i < m_bucket_start[bucket + 1]; i++)
+            {
+                // Different cells can share a bucket; only take entries that really live in this cell
+                const Entry &entry = m_sorted[i];
+                if (entry.m_cell_x == cell_x && entry.m_cell_y == cell_y) m_results.push_back(entry.m_entity);
+            }
+        }
+    }
+    
+    return m_results;
+}
+
+const std::vector<Entity*> &SpatialHash::query_radius(glm::vec3 centre, float radius)
+{
+    query(centre.x - radius, centre.x + radius, centre.y - radius, centre.y + radius);
+    
+    m_results.erase(std::remove_if(m_results.begin(), m_results.end(), [&](Entity *entity)
+    {
+        return glm::distance(entity->get_position(), centre) > radius;
+    }), m_results.end());
+    
+    return m_results;
+}
+
+const std::vector<Entity*> &SpatialHash::query_overlaps(const Entity *entity)
+{
+    glm::vec3 position = entity->get_position();
+    float half_width  = entity->get_width()  / 2.0f,
+          half_height = entity->get_height() / 2.0f;
+    
+    query(position.x - half_width, position.x + half_width, position.y - half_height, position.y + half_height);
+    
+    // Step 1: Gather the candidates into flat arrays
+    m_box_x.clear();
+    m_box_y.clear();
+    m_box_width.clear();
+    m_box_height.clear();
+    
+    int candidate_count = 0;
+    for (Entity *candidate : m_results)
+    {
+        if (candidate == entity || !candidate->get_is_active()) continue;
+        
+        glm::vec3 candidate_position = candidate->get_position();
+        m_box_x.push_back(candidate_position.x);
+        m_box_y.push_back(candidate_position.y);
+        m_box_width.push_back(candidate->get_width());
+        m_box_height.push_back(candidate->get_height());
+        
+        // Compact in place so the kernel's indices map straight back onto m_results
+        m_results[candidate_count++] = candidate;
+    }
+    
+    // Step 2: One batched test against all of them
+    BoxSpan boxes = { m_box_x.data(), m_box_y.data(), m_box_width.data(), m_box_height.data(), candidate_count };
+    m_overlap_indices.resize(candidate_count);
+    
+    int overlap_count = Overlap::one_vs_many(position.x, position.y, entity->get_width(), entity->get_height(),
+                                             boxes, m_overlap_indices.data());
+    
+    m_overlaps.clear();
+    for (int i = 0; i < overlap_count; i++) m_overlaps.push_back(m_results[m_overlap_indices[i]]);
+    
+    return m_overlaps;
+}
@@ -0,0 +1,66 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include "glm/mat4x4.hpp"
+
+class Entity;
+
+/**
+    Uniform-grid broadphase over entity centres. Rebuilt once per tick (clear, insert, build) and then queried
+    by every collision check, so each check only looks at the handful of entities in nearby cells.
+*/
+class SpatialHash {
+private:
+    struct Entry
+    {
+        int     m_cell_x;
+        int     m_cell_y;
+        Entity *m_entity;
+    };
+    
+    float m_cell_size;
+    float m_max_half_extent = 0.0f;
+    int   m_bucket_mask     = 0;
+    
+    std::vector<Entry>   m_entries;      // In insertion order
+    std::vector<Entry>   m_sorted;       // Grouped by bucket after build()
+    std::vector<int>     m_bucket_start; // m_sorted[m_bucket_start[b] .. m_bucket_start[b + 1]) live in bucket b
+    std::vector<Entity*> m_results;
+    
+    // Candidate boxes gathered for the batched narrowphase
+    std::vector<float>   m_box_x, m_box_y, m_box_width, m_box_height;
+    std::vector<int>     m_overlap_indices;
+    std::vector<Entity*> m_overlaps;
+    
+    int const cell_of(float coordinate) const { return (int) floor(coordinate / m_cell_size); }
+    
+    // Hashed in unsigned arithmetic: the products overflow for most cells, which would be undefined for int
+    int const bucket_of(int cell_x, int cell_y) const
+    {
+        uint32_t hash = ((uint32_t) cell_x * 73856093u) ^ ((uint32_t) cell_y * 19349663u);
+        return (int) (hash & (uint32_t) m_bucket_mask);
+    }
+    
+public:
+    // ————— CONSTRUCTOR ————— //
+    SpatialHash(float cell_size = 1.0f);
+    
+    // ————— METHODS ————— //
+    void clear();
+    void insert(Entity *entity);
+    void insert(Entity *entities, int entity_count);
+    void build();
+    
+    // Everything whose box might overlap the given box. Valid until the next query.
+    const std::vector<Entity*> &query(float left, float right, float bottom, float top);
+    const std::vector<Entity*> &query_radius(glm::vec3 centre, float radius);
+    
+    // Every other active entity whose box really overlaps this one's, tested in one batch. Valid until the next call.
+    const std::vector<Entity*> &query_overlaps(const Entity *entity);
+    
+    void set_cell_size(float cell_size) { m_cell_size = cell_size; }
+    
+    // ————— GETTERS ————— //
+    float const get_cell_size()    const { return m_cell_size;            }
+    int   const get_entity_count() const { return (int) m_entries.size(); }
+};
@@ -0,0 +1,106 @@
+#include "SpriteBatch.h"
+
+SpriteBatch::~SpriteBatch()
+{
+    if (m_vertex_buffer_id != 0) glDeleteBuffers(1, &m_vertex_buffer_id);
+}
+
+void SpriteBatch::begin(float alpha)
+{
+    m_alpha = alpha;
+
+    // Keep the buckets (and their capacity) around so steady-state frames don't allocate
+    for (Bucket &bucket : m_buckets) bucket.m_vertices.clear();
+}
+
+SpriteBatch::Bucket &SpriteBatch::get_bucket(GLuint texture_id)
+{
+    // A scene only ever uses a handful of textures, so a linear scan beats a map here
+    for (Bucket &bucket : m_buckets)
+    {
+        if (bucket.m_texture_id == texture_id) return bucket;
+    }
+
+    m_buckets.push_back(Bucket { texture_id, std::vector<float>() });
+    return m_buckets.back();
+}
+
+void SpriteBatch::add(const RenderSprite &sprite)
+{
+    if (sprite.texture_id == 0) return; // Its texture failed to load, so there is nothing to draw
+
+    glm::vec3 position = glm::mix(sprite.previous_position, sprite.position, m_alpha);
+    glm::vec4 uv       = sprite.uv;
+
+    float left   = position.x - 0.5f,
+          right  = position.x + 0.5f,
+          bottom = position.y - 0.5f,
+          top    = position.y + 0.5f;
+
+    float u_left   = uv.x,
+          u_right  = uv.x + uv.z,
+          v_top    = uv.y,
+          v_bottom = uv.y + uv.w;
+
+    std::vector<float> &vertices = get_bucket(sprite.texture_id).m_vertices;
+    vertices.insert(vertices.end(), {
+        left,  bottom, u_left,  v_bottom,
+        right, bottom, u_right, v_bottom,
+        right, top,    u_right, v_top,
+        left,  bottom, u_left,  v_bottom,
+        right, top,    u_right, v_top,
+        left,  top,    u_left,  v_top
+    });
+}
+
+void SpriteBatch::add(const std::vector<RenderSprite> &sprites)
+{
+    for (const RenderSprite &sprite : sprites) add(sprite);
+}
+
+void SpriteBatch::render(ShaderProgram *program)
+{
+    GLStatsScope scope(SUBSYSTEM_SPRITES);
+
+    // Step 1: Pack every bucket back to back so the whole batch is a single upload
+    m_upload.clear();
+    for (const Bucket &bucket : m_buckets)
+    {
+        m_upload.insert(m_upload.end(), bucket.m_vertices.begin(), bucket.m_vertices.end());
+    }
+
+    if (m_upload.empty()) return;
+
+    if (m_vertex_buffer_id == 0) glGenBuffers(1, &m_vertex_buffer_id);
+
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer_id);
+    GLStats::buffer_data(GL_ARRAY_BUFFER, m_upload.size() * sizeof(float), m_upload.data(), GL_STREAM_DRAW);
+
+    // Step 2: Vertices are already in world space
+    program->SetModelMatrix(glm::mat4(1.0f));
+    GLStats::use_program(program->programID);
+
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+
+    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, (void *) 0);
+    GLStats::enable_attribute(program->positionAttribute);
+    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, (void *) (2 * sizeof(float)));
+    GLStats::enable_attribute(program->texCoordAttribute);
+
+    // Step 3: One draw call per texture
+    int first_vertex = 0;
+    for (const Bucket &bucket : m_buckets)
+    {
+        int vertex_count = (int) bucket.m_vertices.size() / FLOATS_PER_VERTEX;
+        if (vertex_count == 0) continue;
+
+        GLStats::bind_texture(GL_TEXTURE_2D, bucket.m_texture_id);
+        GLStats::draw_arrays(GL_TRIANGLES, first_vertex, vertex_count);
+
+        first_vertex += vertex_count;
+    }
+
+    GLStats::disable_attribute(program->positionAttribute);
+    GLStats::disable_attribute(program->texCoordAttribute);
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, 0);
+}
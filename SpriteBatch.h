@@ -0,0 +1,51 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "ShaderProgram.h"
+#include "GLStats.h"
+#include "RenderSnapshot.h"
+
+/**
+    Collects every sprite of a render snapshot into one dynamic vertex buffer. Quads are written in world space
+    and grouped by texture, so a frame costs one upload plus one draw call per distinct texture.
+*/
+class SpriteBatch {
+private:
+    struct Bucket
+    {
+        GLuint             m_texture_id;
+        std::vector<float> m_vertices; // Interleaved x, y, u, v
+    };
+
+    GLuint m_vertex_buffer_id = 0;
+    std::vector<Bucket> m_buckets;
+    std::vector<float>  m_upload;
+    float               m_alpha = 1.0f;
+
+    Bucket &get_bucket(GLuint texture_id);
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int FLOATS_PER_VERTEX = 4;
+    static const int VERTICES_PER_SPRITE = 6;
+
+    // ————— CONSTRUCTOR ————— //
+    ~SpriteBatch();
+
+    // ————— METHODS ————— //
+    // alpha is how far the frame is between the last two steps; sprites are drawn that far along
+    void begin(float alpha);
+    void add(const RenderSprite &sprite);
+    void add(const std::vector<RenderSprite> &sprites);
+    void render(ShaderProgram *program);
+};
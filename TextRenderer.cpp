@@ -0,0 +1,149 @@
+#include "TextRenderer.h"
+
+TextRenderer::TextRenderer(const char *font_filepath)
+{
+    // Shared through the cache, so the font sheet is decoded and uploaded once per process. When it was packed
+    // into an atlas page, the glyphs are drawn from its region of that page.
+    SpriteSheet font_sheet = AssetCache::get_sheet(font_filepath);
+    m_font_texture = font_sheet.m_texture;
+    m_font_region  = font_sheet.m_region;
+    glGenBuffers(1, &m_vertex_buffer_id);
+}
+
+TextRenderer::~TextRenderer()
+{
+    glDeleteBuffers(1, &m_vertex_buffer_id);
+}
+
+int TextRenderer::add_label(std::string text, float screen_size, float spacing, glm::vec3 position)
+{
+    Label label;
+    label.m_text        = text;
+    label.m_screen_size = screen_size;
+    label.m_spacing     = spacing;
+    label.m_position    = position;
+
+    build_label(label);
+    m_labels.push_back(label);
+
+    return (int) m_labels.size() - 1;
+}
+
+void TextRenderer::set_text(int label_id, const std::string &text)
+{
+    Label &label = m_labels[label_id];
+    if (label.m_text == text) return;
+
+    label.m_text = text;
+    build_label(label);
+    if (label.m_is_visible) m_is_dirty = true;
+}
+
+void TextRenderer::set_position(int label_id, glm::vec3 position)
+{
+    Label &label = m_labels[label_id];
+    if (label.m_position == position) return;
+
+    label.m_position = position;
+    build_label(label);
+    if (label.m_is_visible) m_is_dirty = true;
+}
+
+void TextRenderer::set_visible(int label_id, bool is_visible)
+{
+    Label &label = m_labels[label_id];
+    if (label.m_is_visible == is_visible) return;
+
+    label.m_is_visible = is_visible;
+    m_is_dirty = true;
+}
+
+void TextRenderer::set_visible_mask(uint64_t mask)
+{
+    size_t count = m_labels.size() < 64 ? m_labels.size() : 64;
+    for (size_t i = 0; i < count; i++) set_visible((int) i, ((mask >> i) & 1) != 0);
+}
+
+void TextRenderer::build_label(Label &label)
+{
+    mesh_text(label.m_text, label.m_screen_size, label.m_spacing, label.m_position, m_font_region, &label.m_vertices);
+}
+
+void TextRenderer::mesh_text(const std::string &text, float screen_size, float spacing, glm::vec3 position,
+                             glm::vec4 font_region, std::vector<float> *vertices)
+{
+    // Scale the size of the fontbank in the UV-plane
+    float width  = font_region.z / FONTBANK_SIZE;
+    float height = font_region.w / FONTBANK_SIZE;
+
+    float half_size = 0.5f * screen_size;
+
+    vertices->clear();
+    vertices->reserve(text.size() * 6 * FLOATS_PER_VERTEX);
+
+    for (size_t i = 0; i < text.size(); i++) {
+        // 1. Get their index in the spritesheet, as well as their offset (i.e. their position
+        //    relative to the whole sentence)
+        int spritesheet_index = (int) text[i];  // ascii value of character
+        float x = position.x + (screen_size + spacing) * i;
+        float y = position.y;
+
+        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
+        float u = font_region.x + (float) (spritesheet_index % FONTBANK_SIZE) * width;
+        float v = font_region.y + (float) (spritesheet_index / FONTBANK_SIZE) * height;
+
+        // 3. Bake the glyph quad into world space so every label can share one draw call
+        vertices->insert(vertices->end(), {
+            x - half_size, y + half_size, u,         v,
+            x - half_size, y - half_size, u,         v + height,
+            x + half_size, y + half_size, u + width, v,
+            x + half_size, y - half_size, u + width, v + height,
+            x + half_size, y + half_size, u + width, v,
+            x - half_size, y - half_size, u,         v + height,
+        });
+    }
+}
+
+void TextRenderer::upload()
+{
+    std::vector<float> vertices;
+    for (const Label &label : m_labels)
+    {
+        if (label.m_is_visible) vertices.insert(vertices.end(), label.m_vertices.begin(), label.m_vertices.end());
+    }
+
+    m_vertex_count = (int) vertices.size() / FLOATS_PER_VERTEX;
+
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer_id);
+    GLStats::buffer_data(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_DYNAMIC_DRAW);
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, 0);
+
+    m_is_dirty = false;
+}
+
+void TextRenderer::render(ShaderProgram *program)
+{
+    GLStatsScope scope(SUBSYSTEM_TEXT);
+
+    if (m_is_dirty) upload();
+    if (m_vertex_count == 0 || m_font_texture->m_has_failed) return;
+
+    // Glyphs are already in world space
+    program->SetModelMatrix(glm::mat4(1.0f));
+    GLStats::use_program(program->programID);
+
+    GLsizei stride = FLOATS_PER_VERTEX * sizeof(float);
+
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, m_vertex_buffer_id);
+    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, stride, (void *) 0);
+    GLStats::enable_attribute(program->positionAttribute);
+    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, stride, (void *) (2 * sizeof(float)));
+    GLStats::enable_attribute(program->texCoordAttribute);
+
+    GLStats::bind_texture(GL_TEXTURE_2D, m_font_texture->m_id);
+    GLStats::draw_arrays(GL_TRIANGLES, 0, m_vertex_count);
+
+    GLStats::disable_attribute(program->positionAttribute);
+    GLStats::disable_attribute(program->texCoordAttribute);
+    GLStats::bind_buffer(GL_ARRAY_BUFFER, 0);
+}
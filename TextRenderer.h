@@ -0,0 +1,78 @@
+#pragma once
+#define GL_SILENCE_DEPRECATION
+
+#ifdef _WINDOWS
+#include <GL/glew.h>
+#endif
+
+#define GL_GLEXT_PROTOTYPES 1
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <SDL.h>
+#include <SDL_opengl.h>
+#include "glm/mat4x4.hpp"
+#include "glm/gtc/matrix_transform.hpp"
+#include "ShaderProgram.h"
+#include "GLStats.h"
+#include "AssetCache.h"
+
+/**
+    Owns the font atlas and every on-screen label. Each label keeps its own glyph mesh, which is only
+    rebuilt when its text or position changes, and all visible labels are drawn with a single call.
+*/
+class TextRenderer {
+private:
+    struct Label
+    {
+        std::string m_text;
+        float       m_screen_size;
+        float       m_spacing;
+        glm::vec3   m_position;
+        bool        m_is_visible = false;
+
+        // Interleaved x, y, u, v per vertex, already in world space
+        std::vector<float> m_vertices;
+    };
+
+    std::shared_ptr<Texture> m_font_texture;
+    glm::vec4                m_font_region; // The font sheet's part of m_font_texture
+    GLuint m_vertex_buffer_id;
+
+    std::vector<Label> m_labels;
+
+    // Set whenever a label's mesh or visibility changes, so the buffer is only re-uploaded when needed
+    bool m_is_dirty = true;
+    int  m_vertex_count = 0;
+
+    void build_label(Label &label);
+    void upload();
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int FONTBANK_SIZE = 16;
+    static const int FLOATS_PER_VERTEX = 4;
+
+    // ————— CONSTRUCTOR ————— //
+    TextRenderer(const char *font_filepath);
+    ~TextRenderer();
+
+    // ————— METHODS ————— //
+    int  add_label(std::string text, float screen_size, float spacing, glm::vec3 position);
+    void set_text(int label_id, const std::string &text);
+    void set_position(int label_id, glm::vec3 position);
+    void set_visible(int label_id, bool is_visible);
+
+    // Shows exactly the labels whose bits are set (label id n is bit n) and hides the rest of the first 64.
+    // Meant to be called every frame: the buffer is only rebuilt when the set of visible labels changes.
+    void set_visible_mask(uint64_t mask);
+    void render(ShaderProgram *program);
+
+    // The world-space glyph quads for a line of text, as x, y, u, v per vertex, with the UVs mapped into
+    // font_region (all of the texture for a standalone font sheet). No GL involved.
+    static void mesh_text(const std::string &text, float screen_size, float spacing, glm::vec3 position,
+                          glm::vec4 font_region, std::vector<float> *vertices);
+
+    // ————— GETTERS ————— //
+    GLuint const get_font_texture_id() const { return m_font_texture->m_id; }
+};
@@ -0,0 +1,106 @@
+#include "TextureAtlas.h"
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+bool TextureAtlas::load(const char *filepath)
+{
+    std::ifstream file(filepath);
+    if (!file)
+    {
+        LOG("Unable to read atlas manifest " << filepath);
+        return false;
+    }
+
+    m_pages.clear();
+    m_regions.clear();
+
+    std::string line;
+    int line_number = 0;
+
+    while (std::getline(file, line))
+    {
+        line_number++;
+        if (line.empty() || line[0] == '#') continue;
+
+        std::istringstream fields(line);
+        std::string record;
+        fields >> record;
+
+        bool is_valid;
+
+        if (record == "page")
+        {
+            AtlasPage page;
+            is_valid = (bool) (fields >> page.m_filename >> page.m_width >> page.m_height);
+            if (is_valid) m_pages.push_back(page);
+        }
+        else if (record == "region")
+        {
+            AtlasRegion region;
+            is_valid = (bool) (fields >> region.m_name >> region.m_page >> region.m_x >> region.m_y
+                                      >> region.m_width >> region.m_height) &&
+                       region.m_page >= 0 && region.m_page < (int) m_pages.size();
+            if (is_valid) m_regions.push_back(region);
+        }
+        else is_valid = false;
+
+        if (!is_valid)
+        {
+            LOG("Atlas manifest " << filepath << " is corrupt at line " << line_number);
+            m_pages.clear();
+            m_regions.clear();
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool TextureAtlas::save(const char *filepath) const
+{
+    std::ofstream file(filepath);
+    if (!file)
+    {
+        LOG("Unable to write atlas manifest " << filepath);
+        return false;
+    }
+
+    file << "# Generated by tools/atlas_packer.cpp; re-run it rather than editing this file.\n";
+    file << "# page <filename> <width> <height>\n";
+    file << "# region <source sheet> <page> <x> <y> <width> <height>, in pixels from the page's top left\n";
+
+    for (const AtlasPage &page : m_pages)
+    {
+        file << "page " << page.m_filename << ' ' << page.m_width << ' ' << page.m_height << '\n';
+    }
+
+    for (const AtlasRegion &region : m_regions)
+    {
+        file << "region " << region.m_name << ' ' << region.m_page << ' ' << region.m_x << ' ' << region.m_y << ' '
+             << region.m_width << ' ' << region.m_height << '\n';
+    }
+
+    return (bool) file;
+}
+
+const AtlasRegion *TextureAtlas::find(const std::string &name) const
+{
+    // A handful of sheets, looked up once per scene load
+    for (const AtlasRegion &region : m_regions)
+    {
+        if (region.m_name == name) return &region;
+    }
+
+    return NULL;
+}
+
+glm::vec4 const TextureAtlas::get_uv(const AtlasRegion &region) const
+{
+    const AtlasPage &page = m_pages[region.m_page];
+
+    return glm::vec4((float) region.m_x      / page.m_width,  (float) region.m_y      / page.m_height,
+                     (float) region.m_width  / page.m_width,  (float) region.m_height / page.m_height);
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <string>
+#include <vector>
+#include "glm/mat4x4.hpp"
+
+/**
+    One packed image (an atlas page). The filename is relative to the manifest's directory.
+*/
+struct AtlasPage
+{
+    std::string m_filename;
+    int         m_width;
+    int         m_height;
+};
+
+/**
+    Where one source sheet ended up: its page and its rectangle on that page in pixels, padding excluded.
+    Named after the source file, without its directory (e.g. "player.png").
+*/
+struct AtlasRegion
+{
+    std::string m_name;
+    int         m_page;
+    int         m_x, m_y;
+    int         m_width, m_height;
+};
+
+/**
+    The manifest written by tools/atlas_packer.cpp: the atlas pages and the rectangle each source sheet was
+    packed into. A plain text file, one "page" or "region" record per line. No GL here; AssetCache turns
+    pages into textures.
+*/
+class TextureAtlas {
+private:
+    std::vector<AtlasPage>   m_pages;
+    std::vector<AtlasRegion> m_regions;
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int PADDING = 2; // Texels of extruded edge around every region, so neighbours never bleed in
+
+    // ————— METHODS ————— //
+    bool load(const char *filepath);
+    bool save(const char *filepath) const;
+
+    void add_page(const AtlasPage &page)       { m_pages.push_back(page);     }
+    void add_region(const AtlasRegion &region) { m_regions.push_back(region); }
+
+    // NULL when the sheet wasn't packed
+    const AtlasRegion *find(const std::string &name) const;
+
+    // u, v, width, height on the region's page, in the 0-1 range the sprite and tile UVs are mapped into
+    glm::vec4 const get_uv(const AtlasRegion &region) const;
+
+    // ————— GETTERS ————— //
+    int              const get_page_count()   const { return (int) m_pages.size();   }
+    const AtlasPage &      get_page(int page) const { return m_pages[page];          }
+    int              const get_region_count() const { return (int) m_regions.size(); }
+};
@@ -0,0 +1,214 @@
+#include "TextureFile.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+#define LOG(argument) std::cout << argument << '\n'
+
+static_assert(sizeof(TextureFileHeader) == 56, "TextureFileHeader is stored verbatim on disk");
+static_assert(sizeof(TextureMipEntry) == 24,   "TextureMipEntry is stored verbatim on disk");
+
+static const char TEXTURE_MAGIC[4] = { 'P', 'T', 'E', 'X' };
+
+static int bytes_per_texel(uint32_t format)
+{
+    return format == TEXTURE_RGBA4444 ? 2 : 4;
+}
+
+// Halves an RGBA8 image. Colours are averaged weighted by alpha, so transparent texels don't darken the edges
+// of sprites at smaller levels.
+static std::vector<unsigned char> downsample(const std::vector<unsigned char> &rgba, int width, int height,
+                                             int half_width, int half_height)
+{
+    std::vector<unsigned char> half((size_t) half_width * half_height * 4);
+
+    for (int y = 0; y < half_height; y++)
+    {
+        for (int x = 0; x < half_width; x++)
+        {
+            unsigned int color[3] = { 0, 0, 0 };
+            unsigned int alpha    = 0;
+
+            for (int sample = 0; sample < 4; sample++)
+            {
+                int source_x = std::min(2 * x + sample % 2, width  - 1),
+                    source_y = std::min(2 * y + sample / 2, height - 1);
+
+                const unsigned char *texel = &rgba[((size_t) source_y * width + source_x) * 4];
+                for (int channel = 0; channel < 3; channel++) color[channel] += texel[channel] * texel[3];
+                alpha += texel[3];
+            }
+
+            unsigned char *target = &half[((size_t) y * half_width + x) * 4];
+            for (int channel = 0; channel < 3; channel++) target[channel] = alpha == 0 ? 0 : (unsigned char) ((color[channel] + alpha / 2) / alpha);
+            target[3] = (unsigned char) ((alpha + 2) / 4);
+        }
+    }
+
+    return half;
+}
+
+// Lays one level out in the file's format
+static std::vector<unsigned char> convert(const std::vector<unsigned char> &rgba, TextureFormat format)
+{
+    if (format == TEXTURE_RGBA8) return rgba;
+
+    // GL_UNSIGNED_SHORT_4_4_4_4 puts red in the top bits of a native-endian 16-bit value
+    std::vector<unsigned char> packed(rgba.size() / 2);
+    for (size_t texel = 0; texel < rgba.size() / 4; texel++)
+    {
+        uint16_t value = 0;
+        for (int channel = 0; channel < 4; channel++)
+        {
+            value = (uint16_t) ((value << 4) | ((rgba[texel * 4 + channel] * 15 + 127) / 255));
+        }
+        memcpy(&packed[texel * 2], &value, sizeof(value));
+    }
+
+    return packed;
+}
+
+std::shared_ptr<TextureFile> TextureFile::open(const char *filepath)
+{
+    std::shared_ptr<TextureFile> texture = std::make_shared<TextureFile>();
+
+    // No baked file is the normal case for anything that hasn't been through the baker, so it isn't logged
+    if (!texture->m_file.open(filepath)) return nullptr;
+
+    if (!texture->validate())
+    {
+        LOG("Baked texture " << filepath << " is corrupt or from an unsupported version; using the PNG.");
+        return nullptr;
+    }
+
+    return texture;
+}
+
+bool TextureFile::validate()
+{
+    const unsigned char *data = m_file.get_data();
+    uint64_t size = m_file.get_size();
+
+    if (size < sizeof(TextureFileHeader)) return false;
+
+    m_header = (const TextureFileHeader *) data;
+
+    if (memcmp(m_header->magic, TEXTURE_MAGIC, 4) != 0) return false;
+    if (m_header->version != VERSION)                  return false;
+    if (m_header->file_size != size)                   return false;
+    if (m_header->format > TEXTURE_RGBA4444)           return false;
+    if (m_header->width == 0 || m_header->height == 0 || m_header->mip_count == 0 || m_header->mip_count > 32) return false;
+    if (m_header->mip_table_offset + (uint64_t) m_header->mip_count * sizeof(TextureMipEntry) > size) return false;
+
+    m_mips = (const TextureMipEntry *) (data + m_header->mip_table_offset);
+
+    // No checksum pass: that would read every texel, which is the cost this format exists to avoid. Every level
+    // has to be where it says and as large as its size says, which catches truncation and stale layouts.
+    uint32_t width  = m_header->width,
+             height = m_header->height;
+
+    for (uint32_t level = 0; level < m_header->mip_count; level++)
+    {
+        const TextureMipEntry &mip = m_mips[level];
+
+        if (mip.width != width || mip.height != height) return false;
+        if (mip.size != (uint64_t) width * height * bytes_per_texel(m_header->format)) return false;
+        if (mip.offset + mip.size > size) return false;
+
+        width  = std::max(1u, width  / 2);
+        height = std::max(1u, height / 2);
+    }
+
+    return true;
+}
+
+bool TextureFile::write(const char *filepath, const unsigned char *rgba, int width, int height, TextureFormat format,
+                        bool has_mipmaps, TextureFilter min_filter, TextureFilter mag_filter, TextureWrap wrap_s,
+                        TextureWrap wrap_t)
+{
+    // Step 1: Build the levels, each half the last, down to 1 x 1
+    std::vector<std::vector<unsigned char>> levels;
+    std::vector<TextureMipEntry>            mips;
+
+    std::vector<unsigned char> level_rgba(rgba, rgba + (size_t) width * height * 4);
+    int level_width  = width,
+        level_height = height;
+
+    while (true)
+    {
+        levels.push_back(convert(level_rgba, format));
+        mips.push_back(TextureMipEntry { (uint32_t) level_width, (uint32_t) level_height, 0, levels.back().size() });
+
+        if (!has_mipmaps || (level_width == 1 && level_height == 1)) break;
+
+        int half_width  = std::max(1, level_width  / 2),
+            half_height = std::max(1, level_height / 2);
+
+        level_rgba   = downsample(level_rgba, level_width, level_height, half_width, half_height);
+        level_width  = half_width;
+        level_height = half_height;
+    }
+
+    // Step 2: Lay the file out, keeping every section 8-byte aligned, and fill in the header last
+    uint64_t offset = sizeof(TextureFileHeader);
+    uint64_t mip_table_offset = offset;
+    offset += mips.size() * sizeof(TextureMipEntry);
+
+    for (TextureMipEntry &mip : mips)
+    {
+        offset = (offset + 7) & ~(uint64_t) 7;
+        mip.offset = offset;
+        offset += mip.size;
+    }
+
+    TextureFileHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, TEXTURE_MAGIC, 4);
+    header.version          = VERSION;
+    header.width            = (uint32_t) width;
+    header.height           = (uint32_t) height;
+    header.format           = format;
+    header.mip_count        = (uint32_t) mips.size();
+    header.min_filter       = min_filter;
+    header.mag_filter       = mag_filter;
+    header.wrap_s           = wrap_s;
+    header.wrap_t           = wrap_t;
+    header.mip_table_offset = mip_table_offset;
+    header.file_size        = offset;
+
+    std::vector<unsigned char> buffer(offset, 0);
+    memcpy(buffer.data(), &header, sizeof(header));
+    memcpy(buffer.data() + mip_table_offset, mips.data(), mips.size() * sizeof(TextureMipEntry));
+    for (size_t level = 0; level < levels.size(); level++)
+    {
+        memcpy(buffer.data() + mips[level].offset, levels[level].data(), levels[level].size());
+    }
+
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) return false;
+
+    file.write((const char *) buffer.data(), (std::streamsize) buffer.size());
+    return (bool) file;
+}
+
+void TextureFile::prefetch() const
+{
+    // One read per page is enough to fault it in
+    const size_t PAGE_SIZE = 4096;
+
+    volatile unsigned char sink = 0;
+    for (size_t offset = 0; offset < m_file.get_size(); offset += PAGE_SIZE) sink ^= m_file.get_data()[offset];
+    (void) sink;
+}
+
+std::string TextureFile::baked_path(const char *image_filepath)
+{
+    std::string path = image_filepath;
+
+    size_t extension = path.find_last_of('.');
+    size_t separator = path.find_last_of('/');
+    if (extension != std::string::npos && (separator == std::string::npos || extension > separator)) path.erase(extension);
+
+    return path + ".ptex";
+}
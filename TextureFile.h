@@ -0,0 +1,87 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+#include "MappedFile.h"
+
+enum TextureFormat { TEXTURE_RGBA8, TEXTURE_RGBA4444 };
+enum TextureFilter { FILTER_NEAREST, FILTER_LINEAR };
+enum TextureWrap   { WRAP_REPEAT, WRAP_CLAMP };
+
+/**
+    On-disk layout of a .ptex file: this header, the mip table, then every mip level's texels in rows from the
+    top, tightly packed. Sections are 8-byte aligned. The enums are stored as uint32, so the file doesn't depend
+    on GL's values for them.
+*/
+struct TextureFileHeader
+{
+    char     magic[4];
+    uint32_t version;
+
+    uint32_t width;
+    uint32_t height;
+    uint32_t format;     // TextureFormat
+    uint32_t mip_count;  // 1 when the file has no mipmaps
+    uint32_t min_filter; // TextureFilter; with mipmaps, also how levels are blended
+    uint32_t mag_filter; // TextureFilter
+    uint32_t wrap_s;     // TextureWrap
+    uint32_t wrap_t;     // TextureWrap
+
+    uint64_t mip_table_offset; // mip_count TextureMipEntry records, largest level first
+    uint64_t file_size;
+};
+
+struct TextureMipEntry
+{
+    uint32_t width;
+    uint32_t height;
+    uint64_t offset;
+    uint64_t size;
+};
+
+/**
+    A memory-mapped .ptex texture, baked from a PNG by tools/texture_baker.cpp. The texels are already in the
+    layout glTexImage2D takes, so loading one is an mmap plus an upload straight from the mapping; there is
+    nothing to inflate or convert. Nothing here touches GL.
+*/
+class TextureFile {
+private:
+    MappedFile               m_file;
+    const TextureFileHeader *m_header = NULL;
+    const TextureMipEntry   *m_mips   = NULL;
+
+    bool validate();
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const uint32_t VERSION = 1;
+
+    // ————— METHODS ————— //
+    // NULL when there is no baked file or it doesn't check out; callers fall back to the PNG
+    static std::shared_ptr<TextureFile> open(const char *filepath);
+
+    // Converts and lays out rgba (width x height RGBA8, rows from the top) and, if asked, a mip chain below it
+    static bool write(const char *filepath, const unsigned char *rgba, int width, int height, TextureFormat format,
+                      bool has_mipmaps, TextureFilter min_filter, TextureFilter mag_filter, TextureWrap wrap_s,
+                      TextureWrap wrap_t);
+
+    // Where the baked version of an image lives: the same path with .ptex in place of its extension
+    static std::string baked_path(const char *image_filepath);
+
+    // Reads every page of the mapping in, so a later upload doesn't stall on disk. For worker threads.
+    void prefetch() const;
+
+    // ————— GETTERS ————— //
+    int           const get_width()      const { return (int) m_header->width;              }
+    int           const get_height()     const { return (int) m_header->height;             }
+    TextureFormat const get_format()     const { return (TextureFormat) m_header->format;   }
+    int           const get_mip_count()  const { return (int) m_header->mip_count;          }
+    TextureFilter const get_min_filter() const { return (TextureFilter) m_header->min_filter; }
+    TextureFilter const get_mag_filter() const { return (TextureFilter) m_header->mag_filter; }
+    TextureWrap   const get_wrap_s()     const { return (TextureWrap) m_header->wrap_s;     }
+    TextureWrap   const get_wrap_t()     const { return (TextureWrap) m_header->wrap_t;     }
+
+    const TextureMipEntry &get_mip(int level)        const { return m_mips[level];                           }
+    const unsigned char*   get_mip_texels(int level) const { return m_file.get_data() + m_mips[level].offset; }
+};
@@ -0,0 +1,256 @@
+#include "TileGrid.h"
+#include "LevelFile.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+static int count_trailing_zeros(uint64_t word) { unsigned long index; _BitScanForward64(&index, word); return (int) index; }
+#else
+static int count_trailing_zeros(uint64_t word) { return __builtin_ctzll(word); }
+#endif
+
+TileGrid::TileGrid(std::shared_ptr<TileSource> source, float tile_size)
+{
+    m_width  = source->get_width();
+    m_height = source->get_height();
+    m_tile_size = tile_size;
+    m_source = source;
+    
+    build_grid();
+}
+
+TileGrid::TileGrid(std::shared_ptr<LevelFile> level, float tile_size)
+{
+    m_width  = level->get_width();
+    m_height = level->get_height();
+    m_tile_size = tile_size;
+    m_source = level;
+    
+    m_level_data     = level->get_layer(0);
+    m_baked_solidity = level->get_solidity();
+    
+    build_grid();
+}
+
+void TileGrid::build_grid()
+{
+    m_left_bound   = 0 - (m_tile_size / 2);
+    m_right_bound  = (m_tile_size * m_width) - (m_tile_size / 2);
+    m_top_bound    = 0 + (m_tile_size / 2);
+    m_bottom_bound = -(m_tile_size * m_height) + (m_tile_size / 2);
+    
+    build_flag_grids();
+}
+
+void TileGrid::build_flag_grids()
+{
+    m_words_per_row = (m_width + 63) / 64;
+    for (int flag = 0; flag < TILE_FLAG_COUNT; flag++) m_flag_grids[flag].assign((size_t) m_words_per_row * m_height, 0);
+    
+    // With the default properties, solidity is just "non-zero", which is exactly what the level file baked
+    if (m_tile_flags.empty() && m_baked_solidity != NULL)
+    {
+        m_flag_grids[TILE_SOLID].assign(m_baked_solidity, m_baked_solidity + (size_t) m_words_per_row * m_height);
+        return;
+    }
+    
+    // Otherwise read the whole layer once, a strip of rows at a time so huge streamed levels stay bounded
+    std::vector<unsigned int> strip;
+    
+    for (int first_row = 0; first_row < m_height; first_row += CHUNK_SIZE)
+    {
+        int row_count = std::min(CHUNK_SIZE, m_height - first_row);
+        
+        const unsigned int *tiles = m_level_data != NULL ? m_level_data + (size_t) first_row * m_width : NULL;
+        if (tiles == NULL)
+        {
+            strip.resize((size_t) m_width * row_count);
+            m_source->read(0, first_row, m_width, row_count, strip.data());
+            tiles = strip.data();
+        }
+        
+        for (int row = 0; row < row_count; row++)
+        {
+            uint64_t *words[TILE_FLAG_COUNT];
+            for (int flag = 0; flag < TILE_FLAG_COUNT; flag++) words[flag] = &m_flag_grids[flag][(size_t) (first_row + row) * m_words_per_row];
+            
+            for (int x = 0; x < m_width; x++)
+            {
+                unsigned char flags = get_tile_flags(tiles[(size_t) row * m_width + x]);
+                if (flags == 0) continue;
+                
+                for (int flag = 0; flag < TILE_FLAG_COUNT; flag++)
+                {
+                    if (flags & (1 << flag)) words[flag][x / 64] |= 1ull << (x % 64);
+                }
+            }
+        }
+    }
+}
+
+void TileGrid::set_tile_flags(unsigned int tile, unsigned char flags)
+{
+    // Fill in the defaults for every id up to this one before overriding it
+    while (m_tile_flags.size() <= tile) m_tile_flags.push_back(get_tile_flags((unsigned int) m_tile_flags.size()));
+    
+    m_tile_flags[tile] = flags;
+    build_flag_grids();
+}
+
+int TileGrid::query_tiles(float left, float right, float bottom, float top, TileFlag flag, std::vector<TileCoord> *tiles) const
+{
+    tiles->clear();
+    
+    float half_tile = m_tile_size / 2.0f;
+    
+    int first_x = std::max(0,            (int) floor((left    + half_tile) / m_tile_size)),
+        last_x  = std::min(m_width  - 1, (int) floor((right   + half_tile) / m_tile_size)),
+        first_y = std::max(0,            (int) floor((-top    + half_tile) / m_tile_size)), // Rows count down
+        last_y  = std::min(m_height - 1, (int) floor((-bottom + half_tile) / m_tile_size));
+    
+    if (first_x > last_x) return 0;
+    
+    int first_word = first_x / 64,
+        last_word  = last_x  / 64;
+    
+    for (int tile_y = first_y; tile_y <= last_y; tile_y++)
+    {
+        const uint64_t *row = &m_flag_grids[flag][(size_t) tile_y * m_words_per_row];
+        
+        // Whole words at a time; empty stretches cost one compare per 64 tiles
+        for (int word_index = first_word; word_index <= last_word; word_index++)
+        {
+            uint64_t word = row[word_index];
+            if (word_index == first_word) word &= ~0ull << (first_x % 64);
+            if (word_index == last_word && last_x % 64 != 63) word &= (1ull << (last_x % 64 + 1)) - 1;
+            
+            while (word != 0)
+            {
+                tiles->push_back(TileCoord { word_index * 64 + count_trailing_zeros(word), tile_y });
+                word &= word - 1;
+            }
+        }
+    }
+    
+    return (int) tiles->size();
+}
+
+bool TileGrid::is_solid(glm::vec3 position, float *penetration_x, float *penetration_y)
+{
+    *penetration_x = 0;
+    *penetration_y = 0;
+    
+    if (position.x < m_left_bound || position.x > m_right_bound) return false;
+    if (position.y > m_top_bound || position.y < m_bottom_bound) return false;
+    
+    int tile_x = floor((position.x + (m_tile_size / 2)) / m_tile_size);
+    int tile_y = -(ceil(position.y - (m_tile_size / 2))) / m_tile_size; // Our array counts up as Y goes down.
+    
+    if (tile_x < 0 || tile_x >= m_width) return false;
+    if (tile_y < 0 || tile_y >= m_height) return false;
+    
+    if (!has_tile_flag(tile_x, tile_y, TILE_SOLID)) return false;
+    
+    float tile_center_x = (tile_x * m_tile_size);
+    float tile_center_y = -(tile_y * m_tile_size);
+    
+    *penetration_x = (m_tile_size / 2) - fabs(position.x - tile_center_x);
+    *penetration_y = (m_tile_size / 2) - fabs(position.y - tile_center_y);
+    
+    return true;
+}
+
+/**
+    Entry and exit times of a moving interval [near_edge, far_edge] against a fixed one along one axis. Returns
+    false if they never overlap during the move. A start that is already inside by up to max_depth still counts,
+    as a hit at time zero, so resting contacts and small penetrations resolve instead of being ignored.
+*/
+static bool sweep_axis(float box_min, float box_max, float tile_min, float tile_max, float displacement,
+                       float skin, float max_depth, float *entry, float *exit)
+{
+    if (displacement == 0.0f)
+    {
+        // Not moving on this axis, so it's just an overlap test, and grazing contact doesn't count
+        if (box_max - tile_min <= skin || tile_max - box_min <= skin) return false;
+        
+        *entry = -INFINITY;
+        *exit  =  INFINITY;
+        return true;
+    }
+    
+    float depth = displacement > 0.0f ? box_max - tile_min : tile_max - box_min;
+    if (depth > max_depth) return false;
+    
+    if (displacement > 0.0f)
+    {
+        *entry = (tile_min - box_max) / displacement;
+        *exit  = (tile_max - box_min) / displacement;
+    }
+    else
+    {
+        *entry = (tile_max - box_min) / displacement;
+        *exit  = (tile_min - box_max) / displacement;
+    }
+    
+    return true;
+}
+
+bool TileGrid::sweep(glm::vec3 position, float width, float height, glm::vec3 displacement, TileHit *hit)
+{
+    if (displacement.x == 0.0f && displacement.y == 0.0f) return false;
+    
+    float half_tile   = m_tile_size / 2.0f,
+          half_width  = width / 2.0f,
+          half_height = height / 2.0f,
+          skin        = SWEEP_SKIN * m_tile_size;
+    
+    // Step 1: Only the tiles under the swept box can be hit
+    float left   = std::min(position.x, position.x + displacement.x) - half_width,
+          right  = std::max(position.x, position.x + displacement.x) + half_width,
+          bottom = std::min(position.y, position.y + displacement.y) - half_height,
+          top    = std::max(position.y, position.y + displacement.y) + half_height;
+    
+    // Step 2: Earliest entry over every blocking tile in that range. One-way tiles only count when landed on
+    //         from above.
+    bool  is_hit = false;
+    float best_time = 1.0f;
+    
+    for (int flag = TILE_SOLID; flag <= TILE_ONE_WAY; flag++)
+    {
+        bool is_one_way = flag == TILE_ONE_WAY;
+        if (is_one_way && displacement.y >= 0.0f) break;
+        
+        query_tiles(left, right, bottom, top, (TileFlag) flag, &m_swept_tiles);
+        
+        for (const TileCoord &tile : m_swept_tiles)
+        {
+            float tile_left = tile.x * m_tile_size - half_tile,
+                  tile_top  = -tile.y * m_tile_size + half_tile;
+            
+            if (is_one_way && position.y - half_height < tile_top - skin) continue;
+            
+            float entry_x, exit_x, entry_y, exit_y;
+            if (!sweep_axis(position.x - half_width, position.x + half_width, tile_left, tile_left + m_tile_size,
+                            displacement.x, skin, half_tile, &entry_x, &exit_x)) continue;
+            if (!sweep_axis(position.y - half_height, position.y + half_height, tile_top - m_tile_size, tile_top,
+                            displacement.y, skin, half_tile, &entry_y, &exit_y)) continue;
+            
+            float entry = std::max(entry_x, entry_y),
+                  exit  = std::min(exit_x,  exit_y);
+            if (entry > exit || exit <= 0.0f || entry > best_time) continue;
+            
+            // The face hit is on whichever axis was entered last
+            bool is_side = entry_x > entry_y;
+            if (is_one_way && is_side) continue;
+            
+            glm::vec3 normal = is_side ? glm::vec3(displacement.x > 0.0f ? -1.0f : 1.0f, 0.0f, 0.0f)
+                                       : glm::vec3(0.0f, displacement.y > 0.0f ? -1.0f : 1.0f, 0.0f);
+            
+            best_time = std::max(entry, 0.0f);
+            *hit = TileHit { best_time, normal, tile.x, tile.y };
+            is_hit = true;
+        }
+    }
+    
+    return is_hit;
+}
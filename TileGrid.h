@@ -0,0 +1,103 @@
+#pragma once
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include <math.h>
+#include "glm/mat4x4.hpp"
+#include "TileSource.h"
+
+/**
+    Per-tile-id properties, as bits of a flags byte (1 << TILE_SOLID etc.). One-way tiles only stop things
+    landing on them from above; hazards don't block anything.
+*/
+enum TileFlag { TILE_SOLID, TILE_ONE_WAY, TILE_HAZARD };
+
+struct TileCoord
+{
+    int x;
+    int y;
+};
+
+/**
+    The first solid tile a swept box runs into. time is the fraction of the displacement travelled before
+    contact and normal points out of the tile face that was hit.
+*/
+struct TileHit
+{
+    float     time;
+    glm::vec3 normal;
+    int       tile_x;
+    int       tile_y;
+};
+
+class LevelFile;
+
+/**
+    The collision side of a level: tile layout, bounds and the bit-packed flag grids. Needs neither SDL nor
+    GL, so the simulation can run against it directly; Map adds streaming and rendering on top.
+*/
+class TileGrid {
+protected:
+    int m_width;
+    int m_height;
+
+    const unsigned int *m_level_data = NULL;
+    float               m_tile_size;
+
+    std::shared_ptr<TileSource> m_source;
+
+    // ————— TILE PROPERTIES ————— //
+    std::vector<unsigned char> m_tile_flags;          // Indexed by tile id; ids past the end are solid unless 0
+    std::vector<uint64_t>      m_flag_grids[3];       // One bit per tile and flag, rows of m_words_per_row words
+    int                        m_words_per_row = 0;
+    const uint64_t            *m_baked_solidity = NULL;
+    std::vector<TileCoord>     m_swept_tiles;
+
+    float m_left_bound, m_right_bound, m_top_bound, m_bottom_bound;
+
+    TileGrid() {}
+    void build_grid();
+    void build_flag_grids();
+
+public:
+    // ————— STATIC ATTRIBUTES ————— //
+    static const int CHUNK_SIZE      = 32;
+    static const int TILE_FLAG_COUNT = 3;
+    static constexpr float SWEEP_SKIN = 0.001f; // In tiles; overlaps thinner than this are treated as touching
+
+    // ————— CONSTRUCTORS ————— //
+    TileGrid(std::shared_ptr<TileSource> source, float tile_size);
+    TileGrid(std::shared_ptr<LevelFile> level, float tile_size);
+    virtual ~TileGrid() {}
+
+    // ————— METHODS ————— //
+    bool is_solid(glm::vec3 position, float *penetration_x, float *penetration_y);
+    bool sweep(glm::vec3 position, float width, float height, glm::vec3 displacement, TileHit *hit);
+
+    // Every tile with the flag whose square overlaps or touches the rectangle, row by row. Returns the count.
+    int  query_tiles(float left, float right, float bottom, float top, TileFlag flag, std::vector<TileCoord> *tiles) const;
+    void set_tile_flags(unsigned int tile, unsigned char flags); // Setup only: rebuilds the grids the simulation reads unlocked
+
+    // ————— GETTERS ————— //
+    int const get_width()  const  { return this->m_width;  }
+    int const get_height() const  { return this->m_height; }
+
+    const unsigned int* const get_level_data() const { return this->m_level_data; }
+    float               const get_tile_size()  const { return this->m_tile_size;  }
+
+    unsigned char const get_tile_flags(unsigned int tile) const
+    {
+        return tile < m_tile_flags.size() ? m_tile_flags[tile] : (tile != 0 ? 1 << TILE_SOLID : 0);
+    }
+
+    bool const has_tile_flag(int tile_x, int tile_y, TileFlag flag) const
+    {
+        if (tile_x < 0 || tile_x >= m_width || tile_y < 0 || tile_y >= m_height) return false;
+        return (m_flag_grids[flag][(size_t) tile_y * m_words_per_row + tile_x / 64] >> (tile_x % 64)) & 1;
+    }
+
+    float const get_left_bound()   const { return this->m_left_bound;   }
+    float const get_right_bound()  const { return this->m_right_bound;  }
+    float const get_top_bound()    const { return this->m_top_bound;    }
+    float const get_bottom_bound() const { return this->m_bottom_bound; }
+};
@@ -0,0 +1,74 @@
+#define LOG(argument) std::cout << argument << '\n'
+
+#include "TileSource.h"
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+static_assert(sizeof(unsigned int) == sizeof(uint32_t), "tile maps store 32-bit tile indices");
+
+MemoryTileSource::MemoryTileSource(int width, int height, const unsigned int *level_data)
+{
+    m_width      = width;
+    m_height     = height;
+    m_level_data = level_data;
+}
+
+void MemoryTileSource::read(int x, int y, int w, int h, unsigned int *out) const
+{
+    for (int row = 0; row < h; row++)
+    {
+        memcpy(out + row * w, m_level_data + (y + row) * m_width + x, w * sizeof(unsigned int));
+    }
+}
+
+FileTileSource::FileTileSource(const char *filepath)
+{
+    m_file.open(filepath, std::ios::binary);
+    
+    char    magic[4];
+    int32_t dimensions[2];
+    
+    if (!m_file.read(magic, 4) || memcmp(magic, "TMAP", 4) != 0 ||
+        !m_file.read((char *) dimensions, sizeof(dimensions)))
+    {
+        LOG("Unable to read tile map. Make sure the path is correct.");
+        m_file.close();
+        return;
+    }
+    
+    m_width  = dimensions[0];
+    m_height = dimensions[1];
+}
+
+void FileTileSource::read(int x, int y, int w, int h, unsigned int *out) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    
+    for (int row = 0; row < h; row++)
+    {
+        std::streamoff offset = HEADER_SIZE + ((std::streamoff) (y + row) * m_width + x) * sizeof(uint32_t);
+        
+        m_file.clear();
+        m_file.seekg(offset);
+        if (!m_file.read((char *) (out + row * w), w * sizeof(uint32_t)))
+        {
+            // Treat unreadable rows as empty space rather than garbage
+            memset(out + row * w, 0, w * sizeof(unsigned int));
+        }
+    }
+}
+
+bool FileTileSource::write(const char *filepath, int width, int height, const unsigned int *level_data)
+{
+    std::ofstream file(filepath, std::ios::binary);
+    if (!file) return false;
+    
+    int32_t dimensions[2] = { width, height };
+    
+    file.write("TMAP", 4);
+    file.write((const char *) dimensions, sizeof(dimensions));
+    file.write((const char *) level_data, (std::streamsize) width * height * sizeof(uint32_t));
+    
+    return (bool) file;
+}
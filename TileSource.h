@@ -0,0 +1,62 @@
+#pragma once
+#include <fstream>
+#include <mutex>
+#include <string>
+
+/**
+    Where a Map gets its tile indices from. Reads may come from the chunk-meshing worker threads, so
+    implementations must be safe to call concurrently.
+*/
+class TileSource {
+public:
+    virtual ~TileSource() {}
+    
+    virtual int const get_width()  const = 0;
+    virtual int const get_height() const = 0;
+    
+    // Copies the w * h block starting at (x, y) into out, row by row. The block must lie inside the level.
+    virtual void read(int x, int y, int w, int h, unsigned int *out) const = 0;
+};
+
+/**
+    A level that is already in memory, such as the LEVEL_DATA arrays compiled into the scenes.
+*/
+class MemoryTileSource : public TileSource {
+private:
+    int                 m_width;
+    int                 m_height;
+    const unsigned int *m_level_data;
+    
+public:
+    MemoryTileSource(int width, int height, const unsigned int *level_data);
+    
+    int const get_width()  const override { return m_width;  }
+    int const get_height() const override { return m_height; }
+    
+    void read(int x, int y, int w, int h, unsigned int *out) const override;
+};
+
+/**
+    A level streamed from a .tmap file: the magic "TMAP", then int32 width and height, then width * height
+    uint32 tile indices in row-major order. Only the rows of the requested block are read from disk.
+*/
+class FileTileSource : public TileSource {
+private:
+    int                   m_width  = 0;
+    int                   m_height = 0;
+    mutable std::ifstream m_file;
+    mutable std::mutex    m_mutex;
+    
+public:
+    static const int HEADER_SIZE = 12;
+    
+    FileTileSource(const char *filepath);
+    
+    int const get_width()  const override { return m_width;  }
+    int const get_height() const override { return m_height; }
+    bool const is_open()   const          { return m_file.is_open(); }
+    
+    void read(int x, int y, int w, int h, unsigned int *out) const override;
+    
+    static bool write(const char *filepath, int width, int height, const unsigned int *level_data);
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+
+/**
+    Hands whole values from one writing thread to one reading thread without either ever waiting. Of the three
+    slots, the writer owns one, the reader owns one, and the third sits between them. Publishing swaps the
+    writer's slot with the middle one and acquiring swaps the reader's with it, each in a single exchange.
+
+    The reader always gets the newest value published, and values it was too slow to see are skipped. Slots are
+    reused, so the writer has to overwrite every field of get_back(). Whatever capacity a slot's vectors grew
+    to stays, so a steady state doesn't allocate.
+*/
+template <typename T>
+class TripleBuffer {
+private:
+    static const uint8_t INDEX_MASK = 3;
+    static const uint8_t FRESH_BIT  = 4; // Set in m_middle while it holds a value the reader hasn't taken
+
+    T m_slots[3];
+
+    std::atomic<uint8_t> m_middle;
+    uint8_t              m_back  = 1; // Writer only
+    uint8_t              m_front = 2; // Reader only
+
+public:
+    // ————— CONSTRUCTOR ————— //
+    TripleBuffer() : m_middle(0) {}
+
+    // ————— METHODS ————— //
+    // Writer only: the slot to fill in, then publish it
+    T   &get_back() { return m_slots[m_back]; }
+    void publish()  { m_back = m_middle.exchange(m_back | FRESH_BIT, std::memory_order_acq_rel) & INDEX_MASK; }
+
+    // Reader only: takes the newest published value if there's one it hasn't seen, and says whether it did
+    bool acquire()
+    {
+        if ((m_middle.load(std::memory_order_relaxed) & FRESH_BIT) == 0) return false;
+
+        m_front = m_middle.exchange(m_front, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+
+    // ————— GETTERS ————— //
+    const T &get_front() const { return m_slots[m_front]; }
+};
@@ -3,15 +3,17 @@
 #define NUMBER_OF_TEXTURES 1
 #define LEVEL_OF_DETAIL    0
 #define TEXTURE_BORDER     0
-#define FONTBANK_SIZE      16
 
 #include "Utility.h"
 #include <SDL_image.h>
 #include "stb_image.h"
 
 GLuint Utility::load_texture(const char* filepath) {
-    int width, height, number_of_components;
-    unsigned char* image = stbi_load(filepath, &width, &height, &number_of_components, STBI_rgb_alpha);
+    std::shared_ptr<TextureFile> baked = TextureFile::open(TextureFile::baked_path(filepath).c_str());
+    if (baked != nullptr) return upload_texture(*baked);
+    
+    int width, height;
+    unsigned char* image = decode_image(filepath, &width, &height);
     
     if (image == NULL)
     {
@@ -19,10 +21,28 @@ GLuint Utility::load_texture(const char* filepath) {
         assert(false);
     }
     
+    GLuint texture_id = upload_texture(image, width, height);
+    free_image(image);
+    
+    return texture_id;
+}
+
+unsigned char* Utility::decode_image(const char* filepath, int *width, int *height) {
+    int number_of_components;
+    return stbi_load(filepath, width, height, &number_of_components, STBI_rgb_alpha);
+}
+
+void Utility::free_image(unsigned char* pixels) {
+    stbi_image_free(pixels);
+}
+
+GLuint Utility::upload_texture(const unsigned char* pixels, int width, int height) {
+    GLStatsScope scope(SUBSYSTEM_ASSETS);
+    
     GLuint texture_id;
     glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
-    glBindTexture(GL_TEXTURE_2D, texture_id);
-    glTexImage2D(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, image);
+    GLStats::bind_texture(GL_TEXTURE_2D, texture_id);
+    GLStats::tex_image_2d(GL_TEXTURE_2D, LEVEL_OF_DETAIL, GL_RGBA, width, height, TEXTURE_BORDER, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
     
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
@@ -30,66 +50,42 @@ GLuint Utility::load_texture(const char* filepath) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
     
-    stbi_image_free(image);
-    
     return texture_id;
 }
 
-void Utility::draw_text(ShaderProgram *program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position)
-{
-    float width = 1.0f / FONTBANK_SIZE;
-    float height = 1.0f / FONTBANK_SIZE;
-
+GLuint Utility::upload_texture(const TextureFile &texture) {
+    GLStatsScope scope(SUBSYSTEM_ASSETS);
     
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
-    
-    for (int i = 0; i < text.size(); i++) {
-        // 1. Get their index in the spritesheet, as well as their offset (i.e. their position
-        //    relative to the whole sentence)
-        int spritesheet_index = (int) text[i];  // ascii value of character
-        float offset = (screen_size + spacing) * i;
-        
-        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
-        float u_coordinate = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
-        float v_coordinate = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
-
-        // 3. Inset the current pair in both vectors
-        vertices.insert(vertices.end(), {
-            offset + (-0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-        });
-
-        texture_coordinates.insert(texture_coordinates.end(), {
-            u_coordinate, v_coordinate,
-            u_coordinate, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate + width, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate, v_coordinate + height,
-        });
+    GLenum type = texture.get_format() == TEXTURE_RGBA4444 ? GL_UNSIGNED_SHORT_4_4_4_4 : GL_UNSIGNED_BYTE;
+    
+    GLuint texture_id;
+    glGenTextures(NUMBER_OF_TEXTURES, &texture_id);
+    GLStats::bind_texture(GL_TEXTURE_2D, texture_id);
+    
+    // Rows are tightly packed, and a 16-bit row of odd width isn't a multiple of GL's default 4 bytes
+    glPixelStorei(GL_UNPACK_ALIGNMENT, texture.get_format() == TEXTURE_RGBA4444 ? 2 : 4);
+    
+    for (int level = 0; level < texture.get_mip_count(); level++)
+    {
+        const TextureMipEntry &mip = texture.get_mip(level);
+        GLStats::tex_image_2d(GL_TEXTURE_2D, level, GL_RGBA, mip.width, mip.height, TEXTURE_BORDER, GL_RGBA, type,
+                              texture.get_mip_texels(level));
     }
-
-    // 4. And render all of them using the pairs
-    glm::mat4 model_matrix = glm::mat4(1.0f);
-    model_matrix = glm::translate(model_matrix, position);
     
-    program->SetModelMatrix(model_matrix);
-    glUseProgram(program->programID);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    
+    bool has_mipmaps = texture.get_mip_count() > 1;
+    GLint min_filter;
     
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
+    if (texture.get_min_filter() == FILTER_LINEAR) min_filter = has_mipmaps ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR;
+    else                                           min_filter = has_mipmaps ? GL_NEAREST_MIPMAP_NEAREST : GL_NEAREST;
     
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int) (text.size() * 6));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, min_filter);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture.get_mag_filter() == FILTER_LINEAR ? GL_LINEAR : GL_NEAREST);
+    if (has_mipmaps) glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, texture.get_mip_count() - 1);
     
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, texture.get_wrap_s() == WRAP_CLAMP ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, texture.get_wrap_t() == WRAP_CLAMP ? GL_CLAMP_TO_EDGE : GL_REPEAT);
+    
+    return texture_id;
 }
-
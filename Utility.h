@@ -12,10 +12,21 @@
 #include "glm/mat4x4.hpp"
 #include "glm/gtc/matrix_transform.hpp"
 #include "ShaderProgram.h"
+#include "GLStats.h"
+#include "TextureFile.h"
 
 class Utility {
 public:
     // ————— METHODS ————— //
+    // Uses the baked .ptex next to the image when there is one (see TextureFile.h), and decodes the PNG otherwise
     static GLuint load_texture(const char* filepath);
-    static void draw_text(ShaderProgram *program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position);
+    
+    // load_texture in two halves: decoding touches no GL and may run on a worker, uploading needs the context.
+    // Decoded pixels are RGBA8 and must be released with free_image.
+    static unsigned char* decode_image(const char* filepath, int *width, int *height);
+    static void           free_image(unsigned char* pixels);
+    static GLuint         upload_texture(const unsigned char* pixels, int width, int height);
+    
+    // Every level of a baked texture, straight from its mapping, filtered and wrapped the way it was baked
+    static GLuint         upload_texture(const TextureFile &texture);
 };
@@ -0,0 +1,53 @@
+#include "WorkerPool.h"
+#include <algorithm>
+
+WorkerPool::WorkerPool(int thread_count)
+{
+    for (int i = 0; i < thread_count; i++) m_threads.emplace_back(&WorkerPool::run, this);
+}
+
+WorkerPool::~WorkerPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_is_stopping = true;
+    }
+    m_has_job.notify_all();
+
+    for (std::thread &thread : m_threads) thread.join();
+}
+
+void WorkerPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_has_job.notify_one();
+}
+
+void WorkerPool::run()
+{
+    while (true)
+    {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_has_job.wait(lock, [this] { return m_is_stopping || !m_jobs.empty(); });
+
+            // Pending jobs are dropped on shutdown; nobody is left to collect their results
+            if (m_is_stopping) return;
+
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+        }
+        job();
+    }
+}
+
+WorkerPool &WorkerPool::get_shared()
+{
+    // Leave one core for the main thread
+    static WorkerPool pool(std::max(1, (int) std::thread::hardware_concurrency() - 1));
+    return pool;
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+    A small fixed-size pool of background threads shared by the whole game. Jobs must not touch GL; anything
+    that needs the context is handed back to the main thread by the caller.
+*/
+class WorkerPool {
+private:
+    std::vector<std::thread>          m_threads;
+    std::deque<std::function<void()>> m_jobs;
+    std::mutex                        m_mutex;
+    std::condition_variable           m_has_job;
+    bool                              m_is_stopping = false;
+
+    void run();
+
+public:
+    // ————— CONSTRUCTOR ————— //
+    WorkerPool(int thread_count);
+    ~WorkerPool();
+
+    // ————— METHODS ————— //
+    void submit(std::function<void()> job);
+
+    static WorkerPool &get_shared();
+};
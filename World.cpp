@@ -0,0 +1,173 @@
+#include "World.h"
+
+void World::capture_snapshot()
+{
+    m_snapshot.entities.clear();
+    m_snapshot.entities.reserve(1 + m_state.enemy_count);
+    
+    m_snapshot.entities.push_back(m_state.player->capture());
+    for (int i = 0; i < m_state.enemy_count; ++i) m_snapshot.entities.push_back(m_state.enemies[i].capture());
+    
+    m_snapshot.defeated_enemy_count = m_state.defeated_enemy_count;
+    m_snapshot.next_scene_id        = m_state.next_scene_id;
+    m_has_snapshot = true;
+    
+    m_entity_pool.store_previous_positions();
+}
+
+uint64_t const World::get_state_hash() const
+{
+    // Only what the next step reads back; animation frames and textures can't make a run diverge
+    uint64_t hash = LevelFile::hash(&m_state.defeated_enemy_count, sizeof(int), LevelFile::HASH_SEED);
+    
+    for (int i = -1; i < m_state.enemy_count; ++i)
+    {
+        const Entity *entity = i < 0 ? m_state.player : &m_state.enemies[i];
+        
+        glm::vec3 position = entity->get_position();
+        glm::vec3 velocity = entity->get_velocity();
+        
+        float fields[] = {
+            position.x, position.y, velocity.x, velocity.y,
+            (float) entity->get_is_active(), (float) entity->get_ai_state(), (float) entity->m_is_jumping,
+            (float) entity->m_collided_bottom
+        };
+        hash = LevelFile::hash(fields, sizeof(fields), hash);
+    }
+    
+    return hash;
+}
+
+void World::update_spatial_hash()
+{
+    // Two tiles per cell keeps a typical query to a few cells however many entities there are
+    m_spatial_hash.set_cell_size(m_state.tiles->get_tile_size() * 2.0f);
+    
+    m_spatial_hash.clear();
+    m_spatial_hash.insert(m_state.player);
+    m_spatial_hash.insert(m_state.enemies, m_state.enemy_count);
+    m_spatial_hash.build();
+}
+
+void World::reset()
+{
+    // Everything already exists, so this is just a copy: no allocation, no file I/O, no audio calls.
+    // The map holds no gameplay state and keeps its resident chunks.
+    m_state.player->restore(m_snapshot.entities[0]);
+    for (int i = 0; i < m_state.enemy_count; ++i) m_state.enemies[i].restore(m_snapshot.entities[i + 1]);
+    
+    m_state.defeated_enemy_count = m_snapshot.defeated_enemy_count;
+    m_state.next_scene_id        = m_snapshot.next_scene_id;
+    m_state.events.clear();
+    
+    m_entity_pool.store_previous_positions();
+}
+
+void World::step(float delta_time)
+{
+    m_state.events.clear();
+    m_entity_pool.store_previous_positions();
+    update_spatial_hash();
+    
+    // Every entity is integrated exactly once, in bulk, by the pool's kernels. Collision consequences are
+    // applied as soon as the entity that caused them is resolved, so a stomped enemy can't hit back.
+    m_state.player->begin_step(delta_time, m_state.player);
+    for (int i = 0; i < m_state.enemy_count; ++i) m_state.enemies[i].begin_step(delta_time, m_state.player);
+    
+    m_entity_pool.integrate(delta_time);
+    
+    size_t first_event = 0;
+    m_state.player->resolve_y(m_state.tiles, &m_spatial_hash, &m_state.events);
+    apply_events(first_event);
+    
+    for (int i = 0; i < m_state.enemy_count; ++i)
+    {
+        first_event = m_state.events.size();
+        m_state.enemies[i].resolve_y(m_state.tiles, &m_spatial_hash, &m_state.events);
+        apply_events(first_event);
+    }
+    
+    m_entity_pool.advance_x(delta_time);
+    
+    first_event = m_state.events.size();
+    m_state.player->resolve_x(m_state.tiles, &m_spatial_hash, &m_state.events);
+    apply_events(first_event);
+    
+    for (int i = 0; i < m_state.enemy_count; ++i)
+    {
+        first_event = m_state.events.size();
+        m_state.enemies[i].resolve_x(m_state.tiles, &m_spatial_hash, &m_state.events);
+        apply_events(first_event);
+    }
+    
+    m_state.player->end_step(&m_state.events);
+    for (int i = 0; i < m_state.enemy_count; ++i) m_state.enemies[i].end_step(&m_state.events);
+}
+
+void World::apply_events(size_t first_event)
+{
+    for (size_t i = first_event; i < m_state.events.size(); ++i)
+    {
+        const CollisionEvent &event = m_state.events[i];
+        if (event.other == NULL || !event.other->get_is_active()) continue;
+        
+        switch (event.type)
+        {
+            case STOMP:
+                // Whoever is underneath loses, player or enemy
+                event.other->deactivate();
+                if (event.other->get_entity_type() == ENEMY) ++m_state.defeated_enemy_count;
+                break;
+                
+            case HIT:
+                m_state.player->deactivate();
+                break;
+                
+            default:
+                break;
+        }
+    }
+}
+
+void World::spawn_player(const LevelFile &level, Entity *player)
+{
+    for (int i = 0; i < level.get_spawn_count(); ++i)
+    {
+        if (level.get_spawns()[i].entity_type == PLAYER) player->spawn(level.get_spawns()[i]);
+    }
+}
+
+Entity *World::spawn_enemies(const LevelFile &level, unsigned int texture_id, glm::vec4 sprite_region, int *enemy_count)
+{
+    *enemy_count = 0;
+    for (int i = 0; i < level.get_spawn_count(); ++i)
+    {
+        if (level.get_spawns()[i].entity_type == ENEMY) ++*enemy_count;
+    }
+    
+    Entity *enemies = new Entity[*enemy_count];
+    
+    int enemy_index = 0;
+    for (int i = 0; i < level.get_spawn_count(); ++i)
+    {
+        if (level.get_spawns()[i].entity_type != ENEMY) continue;
+        
+        enemies[enemy_index].bind(&m_entity_pool);
+        enemies[enemy_index].spawn(level.get_spawns()[i]);
+        enemies[enemy_index].m_texture_id    = texture_id;
+        enemies[enemy_index].m_sprite_region = sprite_region;
+        ++enemy_index;
+    }
+    
+    m_state.enemy_count          = *enemy_count;
+    m_state.defeated_enemy_count = 0;
+    return enemies;
+}
+
+void World::capture_sprite(const Entity *entity, std::vector<RenderSprite> *sprites)
+{
+    if (!entity->get_is_active()) return;
+    
+    sprites->push_back(RenderSprite { entity->m_texture_id, entity->get_sprite_uv(), entity->get_previous_position(),
+                                      entity->get_position() });
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include <memory>
+#include <vector>
+#include "glm/mat4x4.hpp"
+#include "Entity.h"
+#include "EntityPool.h"
+#include "LevelFile.h"
+#include "RenderSnapshot.h"
+#include "SpatialHash.h"
+#include "TileGrid.h"
+
+// Only held by pointer here; what they are is the Scene side's business
+class Map;
+struct Texture;
+typedef struct _Mix_Music Mix_Music;
+struct Mix_Chunk;
+
+/**
+    Notice that the game's state is now part of the Scene class, not the main file. Only the simulation half
+    is used here; textures, audio and the map's renderer belong to the Scene side.
+*/
+struct GameState
+{
+    // ————— GAME OBJECTS ————— //
+    Map      *map;
+    TileGrid *tiles;   // What entities collide with: the map itself in every level
+    Entity   *player;
+    Entity   *enemies;
+    int       enemy_count;
+    int       defeated_enemy_count;
+    
+    // ————— EVENTS ————— //
+    std::vector<CollisionEvent> events; // Everything that collided during the last step
+    
+    // ————— TEXTURES ————— //
+    std::shared_ptr<Texture> map_texture;
+    std::shared_ptr<Texture> player_texture;
+    std::shared_ptr<Texture> enemy_texture;
+    
+    // ————— AUDIO ————— //
+    std::shared_ptr<Mix_Music> bgm;
+    std::shared_ptr<Mix_Chunk> jump_sfx;
+    
+    // ————— POINTERS TO OTHER SCENES ————— //
+    int next_scene_id;
+};
+
+/**
+    The state a world starts in, captured once after initialise() so that restarts never rebuild anything.
+*/
+struct WorldSnapshot
+{
+    std::vector<EntitySnapshot> entities; // The player, then each enemy
+    int defeated_enemy_count;
+    int next_scene_id;
+};
+
+/**
+    Everything a level needs to simulate itself, with no SDL or GL anywhere: entities, their physics pool, the
+    broadphase and the step that drives them. Scene adds loading, rendering and audio on top, and a headless
+    run can drive a World on its own.
+*/
+class World {
+private:
+    WorldSnapshot m_snapshot;
+    bool          m_has_snapshot = false;
+    
+    void apply_events(size_t first_event);
+    
+public:
+    // ————— ATTRIBUTES ————— //
+    GameState m_state;
+    EntityPool m_entity_pool;
+    SpatialHash m_spatial_hash;
+    
+    // ————— METHODS ————— //
+    virtual ~World() {}
+    
+    void reset();
+    void step(float delta_time);
+    void update_spatial_hash();
+    void capture_snapshot();
+    
+    void    spawn_player(const LevelFile &level, Entity *player);
+    Entity *spawn_enemies(const LevelFile &level, unsigned int texture_id, glm::vec4 sprite_region, int *enemy_count);
+    
+    // Appends what the renderer needs of entity, unless it's inactive. Simulation thread, after a step.
+    static void capture_sprite(const Entity *entity, std::vector<RenderSprite> *sprites);
+    
+    // ————— GETTERS ————— //
+    GameState const get_state()             const { return m_state;             }
+    int       const get_number_of_enemies() const { return m_state.enemy_count; }
+    bool      const is_initialised()        const { return m_has_snapshot;       }
+    bool      const is_moving()             const { return m_entity_pool.has_moved(); } // During the last step
+    
+    uint64_t const get_state_hash() const;
+};
@@ -11,7 +11,6 @@
 #include <GL/glew.h>
 #endif
 
-#include <list>
 #include <SDL_mixer.h>
 #include <SDL.h>
 #include <SDL_opengl.h>
@@ -20,6 +19,14 @@
 #include "ShaderProgram.h"
 #include "cmath"
 #include <ctime>
+#include <chrono>
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "Entity.h"
 #include "Map.h"
@@ -30,17 +37,28 @@
 #include "LevelB.h"
 #include "LevelC.hpp"
 #include "Effects.h"
+#include "TextRenderer.h"
+#include "Replay.h"
+#include "Profiler.h"
+#include "ProfilerOverlay.h"
+#include "GLStats.h"
+#include "FramePacer.h"
+#include "InputQueue.h"
+#include "RenderSnapshot.h"
+#include "TripleBuffer.h"
 
 // ––––– CONSTANTS ––––– //
 const int WINDOW_WIDTH  = 640,
-          WINDOW_HEIGHT = 480,
-          FONTBANK_SIZE = 16;
+          WINDOW_HEIGHT = 480;
 
 const float BG_RED     = 0.1922f,
             BG_BLUE    = 0.549f,
             BG_GREEN   = 0.9059f,
             BG_OPACITY = 1.0f;
 
+const float VIEW_HALF_WIDTH  = 5.0f,
+            VIEW_HALF_HEIGHT = 3.75f;
+
 const int VIEWPORT_X = 0,
           VIEWPORT_Y = 0,
           VIEWPORT_WIDTH  = WINDOW_WIDTH,
@@ -48,9 +66,28 @@ const int VIEWPORT_X = 0,
 
 const char V_SHADER_PATH[] = "shaders/vertex_textured.glsl",
            F_SHADER_PATH[] = "shaders/fragment_textured.glsl",
-           FONT_FILEPATH[] = "/Users/chelsea/Desktop/Final/SDLProject/assets/font1.png";
+           FONT_FILEPATH[] = "/Users/chelsea/Desktop/Final/SDLProject/assets/font1.png",
+           ATLAS_FILEPATH[] = "/Users/chelsea/Desktop/Final/SDLProject/assets/atlas.txt";
+
+const double   NANOSECONDS_IN_SECOND = 1e9;
+const uint64_t FIXED_TIMESTEP_NS     = (uint64_t) (FIXED_TIMESTEP * NANOSECONDS_IN_SECOND);
+
+// After a hitch (a level load, a breakpoint), at most this many steps catch up in one go; the rest of the
+// backlog is dropped and the game runs that much behind the clock, rather than stalling on ever more steps
+const int DEFAULT_MAX_CATCH_UP_STEPS = 5;
+
+// The shortest the render thread idles for when it has nothing new to draw, so it never spins waiting on a
+// simulation that's running late
+const uint64_t MIN_IDLE_NS = 1000000;
+
+const int HEADLESS_DEFAULT_TICKS = 100000;
 
-const float MILLISECONDS_IN_SECOND = 1000.0;
+const double ASSET_UPLOAD_BUDGET_MS = 2.0;
+
+const char PROFILE_FILEPATH[]  = "profile.csv",
+           GL_STATS_FILEPATH[] = "gl_stats.csv";
+
+const PacingMode DEFAULT_PACING = PACING_VSYNC;
 
 
 // ––––– GLOBAL VARIABLES ––––– //
@@ -65,8 +102,17 @@ LevelB *g_levelB;
 LevelC *g_levelC;
 
 Effects *g_effects;
+ProfilerOverlay *g_profiler_overlay;
+FramePacer      *g_frame_pacer;
 Scene   *g_levels[4];
 
+TextRenderer *g_text_renderer;
+int g_start_label,
+    g_title_label,
+    g_level_labels[4],
+    g_lose_label,
+    g_win_label;
+
 SDL_Window* g_display_window;
 bool g_game_is_running = true,
        is_game_running = true,
@@ -77,82 +123,90 @@ glm::mat4 g_view_matrix, g_projection_matrix;
 
 
 
-float g_previous_ticks = 0.0f;
-float g_accumulator = 0.0f;
+int      g_max_catch_up_steps = DEFAULT_MAX_CATCH_UP_STEPS;
+int      g_dropped_step_count = 0;
+uint64_t g_tick_count         = 0;
+
+// The view translation after the last two steps; frames are drawn between them
+glm::vec3 g_previous_camera,
+          g_current_camera;
+bool      g_snap_camera = true; // Set by anything that moves the camera discontinuously
 
-bool g_is_colliding_bottom = false;
+InputQueue g_input_queue;      // Key events on their way to the ticks they fall in
+
+// The simulation runs on its own thread and hands the render thread (main) a snapshot after every tick
+TripleBuffer<RenderSnapshot> g_snapshots;
+std::thread                  g_simulation_thread;
+std::atomic<bool>            g_is_simulating(false),
+                             g_has_simulation_stopped(false);
+
+// Building a scene loads textures and starts music, which only the main thread may do; the simulation thread
+// leaves the scene here and waits for the main thread to build it
+std::mutex              g_initialise_mutex;
+std::condition_variable g_initialise_condition;
+Scene                  *g_scene_to_initialise = NULL;
+bool                    g_was_initialised     = false; // What the last request's initialise() returned
+uint32_t g_seed;
+Replay  *g_recording = NULL;   // Only set by --record
+const char *g_recording_path;
 
 // ––––– GENERAL FUNCTIONS ––––– //
-void switch_to_scene(Scene *scene)
+// Simulation thread: has the main thread build scene, and blocks until it has. Returns what initialise() did.
+bool initialise_on_main_thread(Scene *scene)
 {
-    g_current_scene = scene;
-    g_current_scene->initialise(); // DON'T FORGET THIS STEP!
+    std::unique_lock<std::mutex> lock(g_initialise_mutex);
+    
+    g_scene_to_initialise = scene;
+    g_initialise_condition.wait(lock, [] { return g_scene_to_initialise == NULL; });
+    
+    return g_was_initialised;
 }
 
 
-void draw_text(ShaderProgram *program, GLuint font_texture_id, std::string text, float screen_size, float spacing, glm::vec3 position)
+// Main thread: builds the scene the simulation thread is waiting on, if there is one
+void serve_initialise_request()
 {
-    // Scale the size of the fontbank in the UV-plane
-    // We will use this for spacing and positioning
-    float width = 1.0f / FONTBANK_SIZE;
-    float height = 1.0f / FONTBANK_SIZE;
-
-    // Instead of having a single pair of arrays, we'll have a series of pairs—one for each character
-    // Don't forget to include <vector>!
-    std::vector<float> vertices;
-    std::vector<float> texture_coordinates;
-
-    // For every character...
-    for (int i = 0; i < text.size(); i++) {
-        // 1. Get their index in the spritesheet, as well as their offset (i.e. their position
-        //    relative to the whole sentence)
-        int spritesheet_index = (int) text[i];  // ascii value of character
-        float offset = (screen_size + spacing) * i;
-        
-        // 2. Using the spritesheet index, we can calculate our U- and V-coordinates
-        float u_coordinate = (float) (spritesheet_index % FONTBANK_SIZE) / FONTBANK_SIZE;
-        float v_coordinate = (float) (spritesheet_index / FONTBANK_SIZE) / FONTBANK_SIZE;
-
-        // 3. Inset the current pair in both vectors
-        vertices.insert(vertices.end(), {
-            offset + (-0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (0.5f * screen_size), -0.5f * screen_size,
-            offset + (0.5f * screen_size), 0.5f * screen_size,
-            offset + (-0.5f * screen_size), -0.5f * screen_size,
-        });
-
-        texture_coordinates.insert(texture_coordinates.end(), {
-            u_coordinate, v_coordinate,
-            u_coordinate, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate + width, v_coordinate + height,
-            u_coordinate + width, v_coordinate,
-            u_coordinate, v_coordinate + height,
-        });
-    }
-
-    // 4. And render all of them using the pairs
-    glm::mat4 model_matrix = glm::mat4(1.0f);
-    model_matrix = glm::translate(model_matrix, position);
+    std::lock_guard<std::mutex> lock(g_initialise_mutex);
+    if (g_scene_to_initialise == NULL) return;
     
-    program->SetModelMatrix(model_matrix);
-    glUseProgram(program->programID);
+    g_was_initialised     = g_scene_to_initialise->initialise();
+    g_scene_to_initialise = NULL;
+    g_initialise_condition.notify_all();
+}
+
+
+// Returns false, staying in the current scene, when scene couldn't be built
+bool switch_to_scene(Scene *scene)
+{
+    // The first visit builds the scene; every later one (e.g. a death restart) just rewinds it
+    bool is_built = true;
+    if (scene->is_initialised()) scene->reset();
+    else if (std::this_thread::get_id() == g_simulation_thread.get_id()) is_built = initialise_on_main_thread(scene);
+    else is_built = scene->initialise(); // DON'T FORGET THIS STEP!
     
-    glVertexAttribPointer(program->positionAttribute, 2, GL_FLOAT, false, 0, vertices.data());
-    glEnableVertexAttribArray(program->positionAttribute);
-    glVertexAttribPointer(program->texCoordAttribute, 2, GL_FLOAT, false, 0, texture_coordinates.data());
-    glEnableVertexAttribArray(program->texCoordAttribute);
+    if (!is_built) return false;
     
-    glBindTexture(GL_TEXTURE_2D, font_texture_id);
-    glDrawArrays(GL_TRIANGLES, 0, (int) (text.size() * 6));
+    g_current_scene = scene;
+    g_snap_camera   = true;
+    return true;
+}
+
+
+void create_levels()
+{
+    g_level0  = new Level0();
+    g_levelA  = new LevelA();
+    g_levelB  = new LevelB();
+    g_levelC  = new LevelC();
     
-    glDisableVertexAttribArray(program->positionAttribute);
-    glDisableVertexAttribArray(program->texCoordAttribute);
+    g_levels[0] = g_level0;
+    g_levels[1] = g_levelA;
+    g_levels[2] = g_levelB;
+    g_levels[3] = g_levelC;
 }
 
-void initialise()
+// Returns false when the first scene can't be built, in which case there is nothing to run
+bool initialise()
 {
     SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO);
     g_display_window = SDL_CreateWindow("Hello, Special Effects!",
@@ -172,46 +226,106 @@ void initialise()
     g_program.Load(V_SHADER_PATH, F_SHADER_PATH);
     
     g_view_matrix = glm::mat4(1.0f);
-    g_projection_matrix = glm::ortho(-5.0f, 5.0f, -3.75f, 3.75f, -1.0f, 1.0f);
+    g_projection_matrix = glm::ortho(-VIEW_HALF_WIDTH, VIEW_HALF_WIDTH, -VIEW_HALF_HEIGHT, VIEW_HALF_HEIGHT, -1.0f, 1.0f);
     
     g_program.SetProjectionMatrix(g_projection_matrix);
     g_program.SetViewMatrix(g_view_matrix);
     
-    glUseProgram(g_program.programID);
+    GLStats::use_program(g_program.programID);
     
     glClearColor(BG_RED, BG_BLUE, BG_GREEN, BG_OPACITY);
     
     // enable blending
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-
-    g_level0  = new Level0();
-    g_levelA  = new LevelA();
-    g_levelB  = new LevelB();
-    g_levelC  = new LevelC();
     
-    g_levels[0] = g_level0;
-    g_levels[1] = g_levelA;
-    g_levels[2] = g_levelB;
-    g_levels[3] = g_levelC;
+    // Needs the context, for the swap interval
+    g_frame_pacer->set_mode(g_frame_pacer->get_mode());
     
+    Audio::open();
+    
+    // Opened before anything is loaded, so texture uploads show up in frame 0
+    GLStats::open_log(GL_STATS_FILEPATH);
+    
+    // Every sheet packed by tools/atlas_packer.cpp then comes from one texture; without the manifest each
+    // sheet is still loaded on its own
+    AssetCache::load_atlas(ATLAS_FILEPATH);
+    
+    create_levels();
+    
+    // Everything decodes on the workers at once; level 0 only waits for what it uses itself, and the rest is
+    // uploaded a little per frame while the menu is up
+    AssetCache::request_sheet(FONT_FILEPATH);
+    for (Scene *level : g_levels) level->preload();
    
     // Start at level 0
-    switch_to_scene(g_levels[0]);
-    g_effects = new Effects(g_projection_matrix, g_view_matrix);
+    if (!switch_to_scene(g_levels[0])) return false;
+    g_effects = new Effects(g_projection_matrix, g_view_matrix, g_seed);
     g_effects->start(SHRINK, 2.0f);
     
+    // Labels are meshed once here; render() only toggles which ones are visible
+    g_text_renderer = new TextRenderer(FONT_FILEPATH);
+    g_start_label     = g_text_renderer->add_label("Press Enter to Start", 0.30f, 0.0f,  glm::vec3(2.25f, -3.75f, 0.0f));
+    g_title_label     = g_text_renderer->add_label("PLATFORM PERIL",       0.5f,  0.05f, glm::vec3(1.4f, -2.75f, 0.0f));
+    g_level_labels[0] = -1;
+    g_level_labels[1] = g_text_renderer->add_label("Level 1",              0.5f,  0.05f, glm::vec3(3.4f, -2.50f, 0.0f));
+    g_level_labels[2] = g_text_renderer->add_label("Level 2",              0.5f,  0.05f, glm::vec3(3.4f, -2.50f, 0.0f));
+    g_level_labels[3] = g_text_renderer->add_label("Final Level",          0.5f,  0.05f, glm::vec3(2.4f, -2.50f, 0.0f));
+    g_lose_label      = g_text_renderer->add_label("YOU LOSE!",            0.5f,  0.10f, glm::vec3(2.5f, -3.0f, 0.0f)); // modify this so that if follows the player and doesnt just stay in the same position
+    g_win_label       = g_text_renderer->add_label("YOU WIN!",             0.5f,  0.10f, glm::vec3(2.5f, -3.0f, 0.0f));
+    
+    // F3 toggles it
+    g_profiler_overlay = new ProfilerOverlay(FONT_FILEPATH, g_projection_matrix);
+    
     g_frame_counter = 0;
+    return true;
 }
 
-void process_input()
+// The InputBit a key drives in the simulation, or 0
+uint8_t input_bit(const SDL_Keysym &keysym)
 {
-    // VERY IMPORTANT: If nothing is pressed, we don't want to go anywhere
-    g_current_scene->m_state.player->set_movement(glm::vec3(0.0f));
+    switch (keysym.scancode) {
+        case SDL_SCANCODE_LEFT:   return INPUT_LEFT;
+        case SDL_SCANCODE_RIGHT:  return INPUT_RIGHT;
+        case SDL_SCANCODE_SPACE:  return INPUT_JUMP;
+        case SDL_SCANCODE_RETURN: return INPUT_START;
+        default:                  return 0;
+    }
+}
+
+
+// Returns whether any event came in, since one that changes nothing the simulation sees (e.g. F3) still
+// needs a redraw
+bool process_input()
+{
+    bool has_event = false;
+    
+    // SDL stamps events in milliseconds on its own clock; this moves them onto the one the simulation steps by
+    uint64_t now_ns    = Profiler::now_ns();
+    Uint32   now_ticks = SDL_GetTicks();
     
     SDL_Event event;
     while (SDL_PollEvent(&event))
     {
+        has_event = true;
+        
+        // Keys the simulation sees go through the queue, so each fixed step gets the ones that happened in it
+        if (event.type == SDL_KEYDOWN || event.type == SDL_KEYUP)
+        {
+            uint8_t  bit = input_bit(event.key.keysym);
+            Uint32   age = now_ticks > event.key.timestamp ? now_ticks - event.key.timestamp : 0;
+            uint64_t age_ns = std::min<uint64_t>((uint64_t) age * 1000000, now_ns);
+            
+            // Holding SPACE keeps jumping on every landing, through key repeat, as it always has
+            bool is_held_repeat = event.key.repeat && (bit & (INPUT_LEFT | INPUT_RIGHT));
+            
+            if (bit != 0 && !is_held_repeat &&
+                !g_input_queue.push(event.type == SDL_KEYDOWN ? INPUT_PRESS : INPUT_RELEASE, bit, now_ns - age_ns))
+            {
+                LOG("Input queue is full; dropping a key event");
+            }
+        }
+        
         switch (event.type) {
             // End game
             case SDL_QUIT:
@@ -226,16 +340,11 @@ void process_input()
                         g_game_is_running = false;
                         break;
                         
-                    case SDLK_SPACE:
-                        // Jump
-                        if (g_current_scene->m_state.player->m_collided_bottom)
-                        {
-                            g_current_scene->m_state.player->m_is_jumping = true;
-                            Mix_PlayChannel(-1, g_current_scene->m_state.jump_sfx, 0);
-                        }
+                    case SDLK_F3:
+                        g_profiler_overlay->toggle();
                         break;
-                    case SDLK_RETURN:
-                        if (g_current_scene == g_levels[0]) switch_to_scene(g_levels[1]);
+                    case SDLK_F4:
+                        g_frame_pacer->cycle_mode();
                         break;
 
                     default:
@@ -247,69 +356,49 @@ void process_input()
         }
     }
     
-    const Uint8 *key_state = SDL_GetKeyboardState(NULL);
-
-    if (key_state[SDL_SCANCODE_LEFT])
-    {
-        g_current_scene->m_state.player->m_movement.x = -1.0f;
-        g_current_scene->m_state.player->m_animation_indices = g_current_scene->m_state.player->m_walking[g_current_scene->m_state.player->LEFT];
-    }
-    else if (key_state[SDL_SCANCODE_RIGHT])
-    {
-        g_current_scene->m_state.player->m_movement.x = 1.0f;
-        g_current_scene->m_state.player->m_animation_indices = g_current_scene->m_state.player->m_walking[g_current_scene->m_state.player->RIGHT];
-    }
-    
-    if (glm::length(g_current_scene->m_state.player->m_movement) > 1.0f)
-    {
-        g_current_scene->m_state.player->m_movement = glm::normalize(g_current_scene->m_state.player->m_movement);
-    }
+    return has_event;
 }
 
 
-void update()
+// Everything the simulation learns from the player arrives through here, one tick at a time, so that a
+// recorded run can be fed back exactly
+void apply_input(uint8_t input)
 {
-    g_frame_counter++;
+    Entity *player = g_current_scene->m_state.player;
     
-    float ticks = (float)SDL_GetTicks() / MILLISECONDS_IN_SECOND;
-    float delta_time = ticks - g_previous_ticks;
-    g_previous_ticks = ticks;
+    // VERY IMPORTANT: If nothing is pressed, we don't want to go anywhere
+    player->set_movement(glm::vec3(0.0f));
     
-    delta_time += g_accumulator;
+    if ((input & INPUT_START) && g_current_scene == g_levels[0]) switch_to_scene(g_levels[1]);
     
-    if (delta_time < FIXED_TIMESTEP)
+    if ((input & INPUT_JUMP) && player->m_collided_bottom)
     {
-        g_accumulator = delta_time;
-        return;
+        player->m_is_jumping = true;
+        Audio::play_sound(g_current_scene->m_state.jump_sfx.get());
     }
-    
-    while (delta_time >= FIXED_TIMESTEP) {
-        g_current_scene->update(FIXED_TIMESTEP);
-        g_effects->update(FIXED_TIMESTEP);
-        
-        
-        if (g_is_colliding_bottom == false && g_current_scene->m_state.player->m_collided_bottom) g_effects->start(SHAKE, 1.0f);
-        
-        g_is_colliding_bottom = g_current_scene->m_state.player->m_collided_bottom;
-        
-        delta_time -= FIXED_TIMESTEP;
+
+    if (input & INPUT_LEFT)
+    {
+        player->set_movement(glm::vec3(-1.0f, 0.0f, 0.0f));
+        player->m_animation_indices = player->m_walking[player->LEFT];
     }
-    
-    g_accumulator = delta_time;
-    
-    // Prevent the camera from showing anything outside of the "edge" of the level
-    g_view_matrix = glm::mat4(1.0f);
-    
-    if (g_current_scene->m_state.player->get_position().x > LEVEL1_LEFT_EDGE) {
-        g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-g_current_scene->m_state.player->get_position().x, 3.75, 0));
-    } else {
-        g_view_matrix = glm::translate(g_view_matrix, glm::vec3(-5, 3.75, 0));
+    else if (input & INPUT_RIGHT)
+    {
+        player->set_movement(glm::vec3(1.0f, 0.0f, 0.0f));
+        player->m_animation_indices = player->m_walking[player->RIGHT];
     }
     
-    int defeated_enemy_count = 0;
-    for (int i = 0; i < g_current_scene->get_number_of_enemies(); ++i) {
-        if ((g_current_scene->m_state.enemies[i].get_is_active()) == false) ++defeated_enemy_count;
+    if (glm::length(player->get_movement()) > 1.0f)
+    {
+        player->set_movement(glm::normalize(player->get_movement()));
     }
+}
+
+
+// Level transitions, restarts and game over, driven by the current scene's state after its steps
+void update_progress()
+{
+    int defeated_enemy_count = g_current_scene->m_state.defeated_enemy_count;
 
     // if the player has fallen off the map
     
@@ -318,13 +407,14 @@ void update()
         switch_to_scene(g_current_scene);
     }
     else if (defeated_enemy_count == g_current_scene->get_number_of_enemies()) {
+        // A next level that can't be built restarts this one instead, rather than leaving the player falling
         if (g_current_scene == g_levelA && g_current_scene->m_state.player->get_position().y < -10.0f) {
-            switch_to_scene(g_levelB);
+            if (!switch_to_scene(g_levelB)) switch_to_scene(g_current_scene);
             defeated_enemy_count = 0;
             g_frame_counter = 0;
         }
         else if (g_current_scene == g_levelB && g_current_scene->m_state.player->get_position().y < -10.0f) {
-            switch_to_scene(g_levelC);
+            if (!switch_to_scene(g_levelC)) switch_to_scene(g_current_scene);
             defeated_enemy_count = 0;
             g_frame_counter = 0;
         }
@@ -333,11 +423,6 @@ void update()
         }
     }
     
-    
-    g_view_matrix = glm::translate(g_view_matrix, g_effects->m_view_offset);
-    
-   
-    
     if (!(g_current_scene->m_state.player->get_is_active())) {
         ++g_death_count;
         if (g_death_count < 3) {
@@ -354,72 +439,447 @@ void update()
     }
 }
 
-void render()
+
+// The current scene's hash plus the progress state that lives out here
+uint64_t state_hash()
 {
-    GLuint font_texture_id = Utility::load_texture(FONT_FILEPATH);
-    g_program.SetViewMatrix(g_view_matrix);
-    glClear(GL_COLOR_BUFFER_BIT);
+    int scene_id = 0;
+    while (g_levels[scene_id] != g_current_scene) ++scene_id;
     
-//    bool appear = true;
-    std::list<int> range = {0,1,2,3,4,5,6,7,8,9,10,11,12,13,14,15};
-    for (int i = *(range.begin()); i < *(range.end()); ++i ) {
-        if (g_current_scene == g_levels[0]) {
-            draw_text(&g_program, font_texture_id, "Press Enter to Start", 0.30f, 0.0f, glm::vec3(2.25f, -3.75f, 0.0f));
-            if ((g_frame_counter % 55) == i) {
-                draw_text(&g_program, font_texture_id, "PLATFORM PERIL", 0.5f, 0.05f, glm::vec3(1.4f, -2.75f, 0.0f));
-            }
-        }
+    int progress[] = { scene_id, g_death_count, is_game_running, final_lvl_completed };
+    return LevelFile::hash(progress, sizeof(progress), g_current_scene->get_state_hash());
+}
+
+
+// One fixed step of the whole game, shared by the live loop, headless runs and replays
+void step_tick(uint8_t input)
+{
+    apply_input(input);
+    g_current_scene->update(FIXED_TIMESTEP);
+    update_progress();
+    
+    if (g_recording) g_recording->record(input, state_hash());
+}
+
+
+// Where the view should be translated to for the current step
+glm::vec3 camera_translation()
+{
+    // Prevent the camera from showing anything outside of the "edge" of the level
+    glm::vec3 translation = glm::vec3(-5, 3.75, 0);
+    
+    if (g_current_scene->m_state.player->get_position().x > LEVEL1_LEFT_EDGE) {
+        translation.x = -g_current_scene->m_state.player->get_position().x;
+    }
+    
+    return translation + g_effects->m_view_offset;
+}
+
+
+void update_camera()
+{
+    g_previous_camera = g_current_camera;
+    g_current_camera  = camera_translation();
+    
+    // A level switch or restart would otherwise be drawn as a pan across the map
+    if (g_snap_camera) g_previous_camera = g_current_camera;
+    g_snap_camera = false;
+}
+
+
+// Which HUD labels the current state shows, one bit per label id
+uint64_t const visible_labels()
+{
+    uint64_t labels = 0;
+    
+    // The start label also waits for level 1 to load, which only the render thread can check
+    if (g_current_scene == g_levels[0]) {
+        labels |= 1ull << g_start_label;
+        if ((g_frame_counter % 55) < 16) labels |= 1ull << g_title_label;
     }
-    LOG(g_frame_counter);
     if (g_frame_counter < 500) {
-        if (g_current_scene == g_levels[1]) {
-            draw_text(&g_program, font_texture_id, "Level 1", 0.5f, 0.05f, glm::vec3(3.4f, -2.50f, 0.0f));
-        }
-        else if (g_current_scene == g_levels[2]) {
-            draw_text(&g_program, font_texture_id, "Level 2", 0.5f, 0.05f, glm::vec3(3.4f, -2.50f, 0.0f));
+        for (int i = 1; i < 4; ++i) {
+            if (g_current_scene == g_levels[i]) labels |= 1ull << g_level_labels[i];
         }
-        else if (g_current_scene == g_levels[3]) {
-            draw_text(&g_program, font_texture_id, "Final Level", 0.5f, 0.05f, glm::vec3(2.4f, -2.50f, 0.0f));
-        }
-        
     }
     
     if (!is_game_running) {
-        draw_text(&g_program, font_texture_id, "YOU LOSE!", 0.5f, 0.10f, glm::vec3(2.5f, -3.0f, 0.0f)); // modify this so that if follows the player and doesnt just stay in the same position
+        labels |= 1ull << g_lose_label;
     }
     else if (is_game_running && g_current_scene == g_levels[3] && final_lvl_completed) {
-        draw_text(&g_program, font_texture_id, "YOU WIN!", 0.5f, 0.10f, glm::vec3(2.5f, -3.0f, 0.0f));
+        labels |= 1ull << g_win_label;
     }
+    
+    return labels;
+}
+
+
+// Copies everything the render thread needs out of the current state and hands it over
+void publish_snapshot(uint64_t tick_end_ns)
+{
+    RenderSnapshot &snapshot = g_snapshots.get_back();
+    
+    snapshot.tick        = g_tick_count;
+    snapshot.tick_end_ns = tick_end_ns;
+    
+    snapshot.scene_id = 0;
+    while (g_levels[snapshot.scene_id] != g_current_scene) ++snapshot.scene_id;
+    
+    snapshot.sprites.clear();
+    g_current_scene->capture_sprites(&snapshot.sprites);
+    
+    snapshot.previous_camera = g_previous_camera;
+    snapshot.camera          = g_current_camera;
+    snapshot.is_moving       = g_current_scene->is_moving() || g_previous_camera != g_current_camera;
+    snapshot.visible_labels  = visible_labels();
+    
+    g_snapshots.publish();
+}
+
+
+// One tick of the live game, standing for the slice of real time that ends at tick_end_ns
+void simulate_tick(uint64_t tick_end_ns)
+{
+    // Counted in ticks, so label timings don't depend on the frame rate
+    g_frame_counter++;
+    g_tick_count++;
+    
+    uint8_t input = g_input_queue.take_tick(tick_end_ns);
+    
+    {
+        ProfileScope scope(PHASE_STEP);
+        step_tick(input);
+    }
+    
+    {
+        ProfileScope scope(PHASE_EFFECTS);
+        g_effects->update(FIXED_TIMESTEP);
+    }
+    
+    for (const CollisionEvent &event : g_current_scene->m_state.events)
+    {
+        if (event.type == LANDED && event.subject == g_current_scene->m_state.player) g_effects->start(SHAKE, 1.0f);
+    }
+    
+    update_camera();
+    publish_snapshot(tick_end_ns);
+}
+
+
+/**
+    The simulation thread. Ticks run when real time reaches the end of their slice, however long the render
+    thread takes over its frames. Between ticks this thread sleeps.
+*/
+void run_simulation()
+{
+    uint64_t tick_end_ns = Profiler::now_ns() + FIXED_TIMESTEP_NS;
+    
+    while (g_is_simulating)
+    {
+        FramePacer::wait_until(tick_end_ns);
+        
+        uint64_t now_ns     = Profiler::now_ns();
+        int      step_count = 0;
+        
+        while (now_ns >= tick_end_ns)
+        {
+            if (step_count == g_max_catch_up_steps)
+            {
+                int dropped_count = (int) ((now_ns - tick_end_ns) / FIXED_TIMESTEP_NS) + 1;
+                g_dropped_step_count += dropped_count;
+                tick_end_ns          += dropped_count * FIXED_TIMESTEP_NS;
+                break;
+            }
+            
+            simulate_tick(tick_end_ns);
+            
+            tick_end_ns += FIXED_TIMESTEP_NS;
+            ++step_count;
+        }
+    }
+    
+    g_has_simulation_stopped = true;
+}
+
+
+void start_simulation()
+{
+    // The render thread needs something to draw before the first tick
+    update_camera();
+    publish_snapshot(Profiler::now_ns());
+    g_snapshots.acquire();
+    
+    g_is_simulating     = true;
+    g_simulation_thread = std::thread(run_simulation);
+}
+
+
+void stop_simulation()
+{
+    if (!g_simulation_thread.joinable()) return;
+    
+    g_is_simulating = false;
+    
+    // The last tick may still be waiting on a scene to be built
+    while (!g_has_simulation_stopped)
+    {
+        serve_initialise_request();
+        std::this_thread::yield();
+    }
+    
+    g_simulation_thread.join();
+}
+
+
+// Render thread: draws snapshot alpha of the way from its previous state to its current one, so motion is
+// smooth at any refresh rate. Entities and the camera only ever come from the snapshot. The live Scene is still
+// touched, but only where the simulation thread never writes:
+// - m_state.map is set once by initialise() and never reassigned; reset() leaves it alone
+// - the Map's chunks, meshes and GL buffers belong to this thread alone (see Map)
+// - the simulation only reads the Map's TileGrid half, whose flag grids are fixed once the map is built
+// - is_preloaded() reads requests made before the simulation started, and readiness that only this thread's
+//   process_uploads sets
+// Anything that breaks one of these (editing tiles mid-game, rebuilding the map on reset) has to be handed over
+// through the snapshot instead.
+void render(const RenderSnapshot &snapshot, float alpha)
+{
+    ProfileScope render_scope(PHASE_RENDER);
+    
+    g_view_matrix = glm::translate(glm::mat4(1.0f), glm::mix(snapshot.previous_camera, snapshot.camera, alpha));
+    g_program.SetViewMatrix(g_view_matrix);
+    glClear(GL_COLOR_BUFFER_BIT);
+    
+    uint64_t labels = snapshot.visible_labels;
+    if (!g_levels[1]->is_preloaded()) labels &= ~(1ull << g_start_label);
+    
+    g_text_renderer->set_visible_mask(labels);
+    g_text_renderer->render(&g_program);
+    
+    Scene *scene = g_levels[snapshot.scene_id];
  
-    glUseProgram(g_program.programID);
-    g_current_scene->render(&g_program);
-    SDL_GL_SwapWindow(g_display_window);
+    // Keep the chunks around the camera resident; the view matrix holds the negated camera position
+    glm::vec3 camera_position = glm::vec3(-g_view_matrix[3][0], -g_view_matrix[3][1], 0.0f);
+    scene->m_state.map->stream(camera_position, VIEW_HALF_WIDTH, VIEW_HALF_HEIGHT);
+    
+    GLStats::use_program(g_program.programID);
+    scene->render(&g_program, snapshot.sprites, alpha);
+    g_profiler_overlay->render(&g_program);
 }
 
 void shutdown()
 {
-    SDL_Quit();
+    stop_simulation();
     
     delete g_level0;
     delete g_levelA;
     delete g_levelB;
     delete g_levelC;
     delete g_effects;
+    delete g_text_renderer;
+    delete g_profiler_overlay;
+    
+    g_frame_pacer->log_usage();
+    if (g_dropped_step_count > 0) LOG("Dropped " << g_dropped_step_count << " steps to catch up at most " << g_max_catch_up_steps << " at a time");
+    delete g_frame_pacer;
+    
+    GLStats::close_log();
+    if (Profiler::dump_csv(PROFILE_FILEPATH)) LOG("Wrote " << Profiler::get_session().size() << " frames to " << PROFILE_FILEPATH);
+    
+    if (g_recording)
+    {
+        if (g_recording->save(g_recording_path)) LOG("Recorded " << g_recording->get_tick_count() << " ticks to " << g_recording_path);
+        delete g_recording;
+    }
+    
+    Audio::close();
+    SDL_Quit();
+}
+
+/**
+    Runs the levels with no window, GL context or audio device, as fast as the simulation allows. Nobody is
+    pressing anything, so this measures stepping, collision and AI on their own.
+*/
+int run_headless(int tick_count)
+{
+    AssetCache::set_headless(true);
+    
+    create_levels();
+    if (!switch_to_scene(g_levelA)) return 1;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for (int tick = 0; tick < tick_count; ++tick)
+    {
+        step_tick(0);
+        
+        // There is no game-over screen to sit on, so start the run again
+        if (!is_game_running || final_lvl_completed)
+        {
+            g_death_count       = 0;
+            is_game_running     = true;
+            final_lvl_completed = false;
+            switch_to_scene(g_levelA);
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    LOG(tick_count << " ticks in " << seconds << "s (" << tick_count / seconds << " ticks/s)");
+    
+    delete g_level0;
+    delete g_levelA;
+    delete g_levelB;
+    delete g_levelC;
+    return 0;
+}
+
+/**
+    Feeds a recorded run back through the same ticks, headless and as fast as possible, checking the state
+    hash after every one. Returns non-zero at the first tick that doesn't match the recording.
+*/
+int run_replay(const char *filepath)
+{
+    Replay replay;
+    if (!replay.load(filepath)) return 1;
+    
+    AssetCache::set_headless(true);
+    g_seed = replay.get_seed();
+    
+    create_levels();
+    if (!switch_to_scene(g_levels[0])) return 1;
+    
+    int  tick_count = replay.get_tick_count();
+    bool diverged   = false;
+    
+    auto start = std::chrono::steady_clock::now();
+    
+    for (int tick = 0; tick < tick_count; ++tick)
+    {
+        step_tick(replay.get_input(tick));
+        
+        if (Replay::fold_hash(state_hash()) != replay.get_hash(tick))
+        {
+            LOG("Replay diverged at tick " << tick << " of " << tick_count);
+            diverged = true;
+            break;
+        }
+    }
+    
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if (!diverged) LOG("Replayed " << tick_count << " ticks in " << seconds << "s (" << tick_count / seconds << " ticks/s)");
+    
+    delete g_level0;
+    delete g_levelA;
+    delete g_levelB;
+    delete g_levelC;
+    return diverged ? 1 : 0;
 }
 
 // ––––– DRIVER GAME LOOP ––––– //
 int main(int argc, char* argv[])
 {
-    initialise();
+    // --headless [ticks]: step the simulation without opening anything, e.g. on a build machine
+    if (argc > 1 && strcmp(argv[1], "--headless") == 0)
+    {
+        return run_headless(argc > 2 ? atoi(argv[2]) : HEADLESS_DEFAULT_TICKS);
+    }
+    
+    // --replay file: check a recorded run still plays out the same
+    if (argc > 2 && strcmp(argv[1], "--replay") == 0) return run_replay(argv[2]);
+    
+    g_seed = (uint32_t) time(NULL);
+    
+    // --record file [seed]: play normally and save every tick's input on exit
+    if (argc > 2 && strcmp(argv[1], "--record") == 0)
+    {
+        if (argc > 3 && isdigit(argv[3][0])) g_seed = (uint32_t) strtoul(argv[3], NULL, 10);
+        
+        g_recording      = new Replay(g_seed);
+        g_recording_path = argv[2];
+    }
+    
+    // --pacing vsync|capped|uncapped [fps]: how the loop waits between frames (F4 cycles through them)
+    PacingMode pacing     = DEFAULT_PACING;
+    double     target_fps = FramePacer::DEFAULT_FPS;
+    
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--pacing") != 0) continue;
+        
+        if (!FramePacer::parse_mode(argv[i + 1], &pacing)) LOG("Unknown pacing mode " << argv[i + 1] << "; using " << FramePacer::get_mode_name(pacing));
+        if (i + 2 < argc && atof(argv[i + 2]) > 0.0) target_fps = atof(argv[i + 2]);
+    }
+    
+    g_frame_pacer = new FramePacer(pacing, target_fps);
+    
+    // --max-steps n: how many fixed steps may run back to back to catch up
+    for (int i = 1; i < argc - 1; ++i)
+    {
+        if (strcmp(argv[i], "--max-steps") == 0 && atoi(argv[i + 1]) > 0) g_max_catch_up_steps = atoi(argv[i + 1]);
+    }
+    
+    if (!initialise())
+    {
+        shutdown();
+        return 1;
+    }
+    
+    int  pending_count = AssetCache::process_uploads(ASSET_UPLOAD_BUDGET_MS);
+    bool is_frame_open = false;
+    
+    start_simulation();
     
     while (g_game_is_running)
     {
-        process_input();
-        update();
+        // A frame runs from one present to the next, so passes that skip rendering add to the next frame's time
+        if (!is_frame_open) Profiler::begin_frame();
+        is_frame_open = true;
+        
+        bool has_event;
+        {
+            ProfileScope scope(PHASE_INPUT);
+            has_event = process_input();
+        }
+        serve_initialise_request();
+        
+        bool has_new_snapshot = g_snapshots.acquire();
+        const RenderSnapshot &snapshot = g_snapshots.get_front();
+        
+        int previous_pending_count = pending_count;
+        pending_count = AssetCache::process_uploads(ASSET_UPLOAD_BUDGET_MS);
         
 //        if (g_current_scene->m_state.next_scene_id >= 0) switch_to_scene(g_levels[g_current_scene->m_state.next_scene_id]);
         
-        render();
+        // No new tick, nothing was pressed, nothing finished loading and nothing is mid-move between two
+        // ticks: the last frame is still right, so sleep until the next snapshot is due instead of drawing it
+        // again. Uncapped always draws, as a baseline.
+        bool is_unchanged = !has_new_snapshot && !has_event && pending_count == previous_pending_count &&
+                            !snapshot.is_moving;
+        
+        if (is_unchanged && g_frame_pacer->get_mode() != PACING_UNCAPPED)
+        {
+            g_frame_pacer->count_frame(false);
+            
+            ProfileScope scope(PHASE_WAIT);
+            FramePacer::wait_until(std::max(snapshot.tick_end_ns + FIXED_TIMESTEP_NS, Profiler::now_ns() + MIN_IDLE_NS));
+            continue;
+        }
+        
+        // The snapshot's tick ended tick_end_ns; frames are drawn up to one tick behind it
+        double alpha = (double) ((int64_t) (Profiler::now_ns() - snapshot.tick_end_ns)) / FIXED_TIMESTEP_NS;
+        render(snapshot, (float) std::min(std::max(alpha, 0.0), 1.0));
+        
+        // Timed on its own, since with vsync this is where a fast frame waits
+        {
+            ProfileScope scope(PHASE_SWAP);
+            SDL_GL_SwapWindow(g_display_window);
+        }
+        
+        g_frame_pacer->count_frame(true);
+        g_frame_pacer->wait_for_next_frame();
+        
+        Profiler::end_frame();
+        GLStats::end_frame();
+        is_frame_open = false;
     }
     
     shutdown();
@@ -0,0 +1,300 @@
+/**
+    Packs the game's sprite, tile and font sheets into as few atlas pages as fit, so that the map, sprites and
+    text can all be drawn from one texture. Writes atlas0.png (atlas1.png, ... if one page isn't enough) and the
+    atlas.txt manifest that AssetCache reads (see TextureAtlas.h) into the assets directory.
+
+    Every sheet keeps its own layout inside its region, so frame indices and tile indices mean what they always
+    did; only the UVs they map to move. Each region is surrounded by TextureAtlas::PADDING texels of its own edge,
+    repeated outwards, so nothing from a neighbouring sheet can be sampled at a region's border.
+
+    Re-run level_converter afterwards: the baked chunk meshes are keyed to the tileset's region.
+
+    usage: atlas_packer <assets directory> [sheet ...]
+*/
+#define LOG(argument) std::cout << argument << '\n'
+#define STB_IMAGE_IMPLEMENTATION
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+
+#include <algorithm>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "stb_image_write.h"
+#include "../TextureAtlas.h"
+
+// Large enough for every sheet the game ships, small enough for any GL implementation we run on
+#define MAX_PAGE_SIZE 4096
+
+// Candidate page widths are tried in these steps; finer doesn't buy a noticeably smaller page
+#define WIDTH_STEP 16
+
+const char *DEFAULT_SHEETS[] = { "tileset3.png", "player.png", "ghost.png", "font1.png" };
+
+struct Sheet
+{
+    std::string    m_name;
+    unsigned char *m_pixels;
+    int            m_width, m_height;
+
+    // The size of the sheet's cell on the page, padding included
+    int const get_cell_width()  const { return m_width  + 2 * TextureAtlas::PADDING; }
+    int const get_cell_height() const { return m_height + 2 * TextureAtlas::PADDING; }
+};
+
+struct Placement
+{
+    int m_sheet;
+    int m_x, m_y; // Top left of the cell
+};
+
+/**
+    The top edge of everything placed so far, as runs of equal height from left to right. A cell goes wherever it
+    rests lowest, which keeps rows of similar heights together without tracking every free rectangle.
+*/
+struct SkylineSegment
+{
+    int m_x, m_y, m_width;
+};
+
+// Where a cell of the given size would rest if its left edge were at segment index; false if it doesn't fit
+bool rest_on(const std::vector<SkylineSegment> &skyline, int index, int width, int height, int page_width,
+             int page_height, int *y)
+{
+    int x = skyline[index].m_x;
+    if (x + width > page_width) return false;
+
+    *y = 0;
+    for (int i = index, remaining = width; remaining > 0; i++)
+    {
+        *y = std::max(*y, skyline[i].m_y);
+        remaining -= skyline[i].m_width;
+    }
+
+    return *y + height <= page_height;
+}
+
+void add_to_skyline(std::vector<SkylineSegment> &skyline, int index, int x, int y, int width)
+{
+    skyline.insert(skyline.begin() + index, SkylineSegment { x, y, width });
+
+    // Trim whatever the new segment now covers
+    for (size_t i = index + 1; i < skyline.size();)
+    {
+        int covered = x + width - skyline[i].m_x;
+        if (covered <= 0) break;
+
+        if (covered >= skyline[i].m_width)
+        {
+            skyline.erase(skyline.begin() + i);
+            continue;
+        }
+
+        skyline[i].m_x     += covered;
+        skyline[i].m_width -= covered;
+        break;
+    }
+
+    // Neighbours at the same height are one segment
+    for (size_t i = 0; i + 1 < skyline.size();)
+    {
+        if (skyline[i].m_y == skyline[i + 1].m_y)
+        {
+            skyline[i].m_width += skyline[i + 1].m_width;
+            skyline.erase(skyline.begin() + i + 1);
+            continue;
+        }
+
+        i++;
+    }
+}
+
+/**
+    Places as many of the given sheets (tallest first) as fit on a page_width x max_height page. Sheets that don't
+    fit are left in leftovers; the height the page actually needs is returned.
+*/
+int pack_page(const std::vector<Sheet> &sheets, const std::vector<int> &order, int page_width, int max_height,
+              std::vector<Placement> *placements, std::vector<int> *leftovers)
+{
+    std::vector<SkylineSegment> skyline = { SkylineSegment { 0, 0, page_width } };
+    int used_height = 0;
+
+    placements->clear();
+    leftovers->clear();
+
+    for (int sheet : order)
+    {
+        int width  = sheets[sheet].get_cell_width(),
+            height = sheets[sheet].get_cell_height();
+
+        int best_index = -1, best_y = 0;
+        for (int i = 0; i < (int) skyline.size(); i++)
+        {
+            int y;
+            if (rest_on(skyline, i, width, height, page_width, max_height, &y) && (best_index < 0 || y < best_y))
+            {
+                best_index = i;
+                best_y     = y;
+            }
+        }
+
+        if (best_index < 0)
+        {
+            leftovers->push_back(sheet);
+            continue;
+        }
+
+        int x = skyline[best_index].m_x;
+        add_to_skyline(skyline, best_index, x, best_y + height, width);
+
+        placements->push_back(Placement { sheet, x, best_y });
+        used_height = std::max(used_height, best_y + height);
+    }
+
+    return used_height;
+}
+
+// Copies the sheet into its cell and repeats its outermost texels into the padding around it
+void blit(const Sheet &sheet, const Placement &placement, std::vector<unsigned char> &page, int page_width)
+{
+    for (int y = 0; y < sheet.get_cell_height(); y++)
+    {
+        int source_y = std::min(std::max(y - TextureAtlas::PADDING, 0), sheet.m_height - 1);
+
+        for (int x = 0; x < sheet.get_cell_width(); x++)
+        {
+            int source_x = std::min(std::max(x - TextureAtlas::PADDING, 0), sheet.m_width - 1);
+
+            const unsigned char *source = &sheet.m_pixels[((size_t) source_y * sheet.m_width + source_x) * 4];
+            unsigned char *destination  = &page[((size_t) (placement.m_y + y) * page_width + placement.m_x + x) * 4];
+            std::copy(source, source + 4, destination);
+        }
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        LOG("usage: atlas_packer <assets directory> [sheet ...]");
+        return 1;
+    }
+
+    std::string directory = std::string(argv[1]) + "/";
+
+    std::vector<std::string> names;
+    for (int i = 2; i < argc; i++) names.push_back(argv[i]);
+    if (names.empty()) names.assign(std::begin(DEFAULT_SHEETS), std::end(DEFAULT_SHEETS));
+
+    // Step 1: Decode every sheet to RGBA
+    std::vector<Sheet> sheets;
+    long long sheet_area = 0;
+
+    for (const std::string &name : names)
+    {
+        Sheet sheet;
+        int number_of_components;
+
+        sheet.m_name   = name;
+        sheet.m_pixels = stbi_load((directory + name).c_str(), &sheet.m_width, &sheet.m_height, &number_of_components,
+                                   STBI_rgb_alpha);
+
+        if (sheet.m_pixels == NULL)
+        {
+            LOG("Unable to load " << directory + name);
+            return 1;
+        }
+
+        if (sheet.get_cell_width() > MAX_PAGE_SIZE || sheet.get_cell_height() > MAX_PAGE_SIZE)
+        {
+            LOG(name << " is " << sheet.m_width << "x" << sheet.m_height << "; pages are at most " << MAX_PAGE_SIZE);
+            return 1;
+        }
+
+        sheets.push_back(sheet);
+        sheet_area += (long long) sheet.m_width * sheet.m_height;
+    }
+
+    std::vector<int> remaining;
+    for (int i = 0; i < (int) sheets.size(); i++) remaining.push_back(i);
+
+    std::sort(remaining.begin(), remaining.end(), [&](int a, int b) {
+        return sheets[a].get_cell_height() > sheets[b].get_cell_height();
+    });
+
+    // Step 2: Fill pages until every sheet is placed. Each page takes the width that fits the most sheets in the
+    // least area, so a handful of small sheets doesn't end up on a mostly empty 4096 x 4096 page.
+    TextureAtlas atlas;
+    long long page_area = 0;
+
+    while (!remaining.empty())
+    {
+        int widest = 0;
+        for (int sheet : remaining) widest = std::max(widest, sheets[sheet].get_cell_width());
+
+        std::vector<Placement> best_placements, placements;
+        std::vector<int>       best_leftovers,  leftovers;
+        int best_width = 0, best_height = 0;
+
+        for (int width = widest; width <= MAX_PAGE_SIZE; width = std::min(width + WIDTH_STEP, MAX_PAGE_SIZE + 1))
+        {
+            int height = pack_page(sheets, remaining, width, MAX_PAGE_SIZE, &placements, &leftovers);
+
+            bool is_better = best_width == 0 ||
+                             placements.size() > best_placements.size() ||
+                             (placements.size() == best_placements.size() &&
+                              (long long) width * height < (long long) best_width * best_height);
+
+            if (is_better)
+            {
+                best_placements = placements;
+                best_leftovers  = leftovers;
+                best_width      = width;
+                best_height     = height;
+            }
+
+            if (width == MAX_PAGE_SIZE) break;
+        }
+
+        int page_index = atlas.get_page_count();
+        std::string filename = "atlas" + std::to_string(page_index) + ".png";
+
+        std::vector<unsigned char> page((size_t) best_width * best_height * 4, 0);
+
+        for (const Placement &placement : best_placements)
+        {
+            const Sheet &sheet = sheets[placement.m_sheet];
+            blit(sheet, placement, page, best_width);
+
+            atlas.add_region(AtlasRegion {
+                sheet.m_name, page_index,
+                placement.m_x + TextureAtlas::PADDING, placement.m_y + TextureAtlas::PADDING,
+                sheet.m_width, sheet.m_height
+            });
+        }
+
+        // Step 3: Write the page out
+        if (!stbi_write_png((directory + filename).c_str(), best_width, best_height, 4, page.data(), best_width * 4))
+        {
+            LOG("Unable to write " << directory + filename);
+            return 1;
+        }
+
+        atlas.add_page(AtlasPage { filename, best_width, best_height });
+        page_area += (long long) best_width * best_height;
+
+        LOG("Wrote " << directory + filename << " (" << best_width << "x" << best_height << ", "
+            << best_placements.size() << " sheets)");
+
+        remaining = best_leftovers;
+    }
+
+    for (Sheet &sheet : sheets) stbi_image_free(sheet.m_pixels);
+
+    if (!atlas.save((directory + "atlas.txt").c_str())) return 1;
+
+    LOG("Wrote " << directory << "atlas.txt: " << atlas.get_region_count() << " sheets on " << atlas.get_page_count()
+        << " page(s), " << (int) (100.0 * sheet_area / page_area) << "% of the area used");
+
+    return 0;
+}
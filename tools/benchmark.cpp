@@ -0,0 +1,457 @@
+/**
+    Microbenchmarks for the engine's hot paths: tile queries, grid and mesh building, stepping a world with
+    growing enemy counts, the entity narrowphase and text meshing. Every case reports ns/op, heap allocations
+    per op and throughput, and the whole run is written out as JSON so two builds can be diffed. Before any of
+    that, it checks that the vector and scalar entity kernels agree, and exits with 1 if they don't.
+
+    usage: benchmark [output.json] [min_seconds_per_case]
+*/
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include "../World.h"
+#include "../Map.h"
+#include "../TextRenderer.h"
+
+// ————— ALLOCATION COUNTING ————— //
+// Every allocation in the process goes through these, so a case's count includes whatever the engine does
+// on its behalf (vector growth, hash rebuilds, ...)
+static size_t g_allocation_count = 0;
+
+void *operator new(size_t size)
+{
+    ++g_allocation_count;
+    if (void *memory = malloc(size == 0 ? 1 : size)) return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](size_t size) { return operator new(size); }
+void  operator delete(void *memory) noexcept             { free(memory); }
+void  operator delete[](void *memory) noexcept           { free(memory); }
+void  operator delete(void *memory, size_t) noexcept     { free(memory); }
+void  operator delete[](void *memory, size_t) noexcept   { free(memory); }
+
+// ————— HARNESS ————— //
+struct BenchmarkResult
+{
+    std::string name;
+    long long   size;            // The case's scale parameter: tiles, entities, glyphs...
+    long long   iterations;
+    double      ns_per_op;
+    double      allocations_per_op;
+    double      items_per_second; // ops/s times the items each op handles
+};
+
+static double g_min_seconds = 0.25;
+static std::vector<BenchmarkResult> g_results;
+
+// Runs `op` in doubling batches until one batch takes at least g_min_seconds, then reports that batch
+static void run(const std::string &name, long long size, double items_per_op, const std::function<void()> &op)
+{
+    op(); // Warm caches and let any lazy first-call allocations happen outside the measurement
+
+    long long iterations = 1;
+    for (;;)
+    {
+        size_t allocations_before = g_allocation_count;
+        auto   start              = std::chrono::steady_clock::now();
+
+        for (long long i = 0; i < iterations; i++) op();
+
+        double seconds     = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        size_t allocations = g_allocation_count - allocations_before;
+
+        if (seconds >= g_min_seconds || iterations >= (1ll << 40))
+        {
+            BenchmarkResult result = {
+                name, size, iterations, seconds * 1e9 / iterations, (double) allocations / iterations,
+                items_per_op * iterations / seconds
+            };
+            g_results.push_back(result);
+
+            char line[160];
+            snprintf(line, sizeof(line), "%-22s %10lld %14.1f ns/op %10.2f allocs/op %14.4g items/s",
+                     name.c_str(), size, result.ns_per_op, result.allocations_per_op, result.items_per_second);
+            LOG(line);
+            return;
+        }
+
+        iterations *= 2;
+    }
+}
+
+static bool write_json(const char *filepath)
+{
+    std::ofstream file(filepath);
+    if (!file) return false;
+
+    file << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < g_results.size(); i++)
+    {
+        const BenchmarkResult &result = g_results[i];
+        char line[320];
+        snprintf(line, sizeof(line),
+                 "    {\"name\": \"%s\", \"size\": %lld, \"iterations\": %lld, \"ns_per_op\": %.3f, "
+                 "\"allocations_per_op\": %.3f, \"items_per_second\": %.1f}%s\n",
+                 result.name.c_str(), result.size, result.iterations, result.ns_per_op,
+                 result.allocations_per_op, result.items_per_second, i + 1 < g_results.size() ? "," : "");
+        file << line;
+    }
+    file << "  ]\n}\n";
+
+    return (bool) file;
+}
+
+// ————— SYNTHETIC LEVELS ————— //
+// A fixed LCG rather than rand(), so every run (and every build) benchmarks the same layout
+static unsigned int g_random_state = 12345;
+
+static unsigned int next_random()
+{
+    g_random_state = g_random_state * 1103515245u + 12345u;
+    return g_random_state >> 8;
+}
+
+// Solid floor along the bottom two rows, plus scattered platforms covering roughly a fifth of the rest
+static std::vector<unsigned int> make_level(int width, int height)
+{
+    std::vector<unsigned int> level_data((size_t) width * height, 0);
+
+    for (int y = 0; y < height; y++)
+    {
+        for (int x = 0; x < width; x++)
+        {
+            bool is_floor = y >= height - 2;
+            if (is_floor || next_random() % 5 == 0) level_data[(size_t) y * width + x] = 1 + next_random() % 3;
+        }
+    }
+
+    return level_data;
+}
+
+// Like make_level, but only the floor is solid, so walkers have somewhere to walk
+static std::vector<unsigned int> make_floor_level(int width, int height)
+{
+    std::vector<unsigned int> level_data((size_t) width * height, 0);
+    for (int x = 0; x < width; x++) level_data[(size_t) (height - 1) * width + x] = 1;
+    return level_data;
+}
+
+// ————— CHECKS ————— //
+// Fills one pool slot with a random float per field, drawn from `state`. Some fields get awkward values
+// (infinities, NaNs, denormals) so the check covers what masking with a multiply used to get wrong.
+static void fill_slot(EntityPool &pool, int slot, unsigned int &state)
+{
+    const float SPECIALS[] = { INFINITY, -INFINITY, NAN, 1e-40f, -0.0f, 3.4e38f };
+
+    std::vector<float> *fields[] = {
+        &pool.m_position_x, &pool.m_position_y, &pool.m_velocity_x, &pool.m_velocity_y,
+        &pool.m_acceleration_x, &pool.m_acceleration_y, &pool.m_movement_x, &pool.m_speed
+    };
+
+    for (std::vector<float> *field : fields)
+    {
+        state = state * 1103515245u + 12345u;
+        unsigned int random = state >> 8;
+
+        (*field)[slot] = random % 16 == 0 ? SPECIALS[(random >> 4) % 6] : (float) (random % 20001) / 100.0f - 100.0f;
+    }
+
+    state = state * 1103515245u + 12345u;
+    pool.m_active[slot] = (state >> 8) % 3 == 0 ? 0.0f : 1.0f;
+}
+
+// The SSE kernels have to leave exactly what the scalar loop would, bit for bit, or a replay recorded on one
+// build won't play back on another. Runs each entity once in a full group of four, where the vector path takes
+// it, and once alone, where the scalar tail does, then compares every field.
+static bool check_entity_kernels()
+{
+    const int   GROUP_COUNT    = 4096;
+    const float FIXED_TIMESTEP = 0.0166666f;
+
+    unsigned int state = 777; // Separate from g_random_state, so the benchmark cases see the same levels as ever
+
+    EntityPool grouped;
+    for (int i = 0; i < GROUP_COUNT * 4; i++) fill_slot(grouped, grouped.allocate(), state);
+
+    EntityPool single;
+    single.allocate();
+
+    grouped.integrate(FIXED_TIMESTEP);
+    grouped.advance_x(FIXED_TIMESTEP);
+
+    state = 777;
+    for (int i = 0; i < GROUP_COUNT * 4; i++)
+    {
+        fill_slot(single, 0, state);
+        single.integrate(FIXED_TIMESTEP);
+        single.advance_x(FIXED_TIMESTEP);
+
+        const std::vector<float> EntityPool::*fields[] = {
+            &EntityPool::m_position_x, &EntityPool::m_position_y, &EntityPool::m_velocity_x, &EntityPool::m_velocity_y
+        };
+
+        for (const std::vector<float> EntityPool::*field : fields)
+        {
+            if (memcmp(&(grouped.*field)[i], &(single.*field)[0], sizeof(float)) != 0)
+            {
+                LOG("Entity kernels disagree at slot " << i << ": " << (grouped.*field)[i] << " (vector) vs "
+                    << (single.*field)[0] << " (scalar)");
+                return false;
+            }
+        }
+    }
+
+    LOG("Entity kernels match bit for bit over " << GROUP_COUNT * 4 << " entities");
+    return true;
+}
+
+// ————— CASES ————— //
+static void benchmark_is_solid()
+{
+    const int SIZE = 256, QUERY_COUNT = 4096;
+
+    std::vector<unsigned int> level_data = make_level(SIZE, SIZE);
+    TileGrid grid(std::make_shared<MemoryTileSource>(SIZE, SIZE, level_data.data()), 1.0f);
+
+    std::vector<glm::vec3> queries;
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        queries.push_back(glm::vec3(next_random() % (SIZE * 100) / 100.0f, -(next_random() % (SIZE * 100) / 100.0f), 0.0f));
+    }
+
+    int   query_index = 0;
+    float penetration_x, penetration_y;
+    volatile int solid_count = 0;
+
+    run("tile_is_solid", SIZE * SIZE, 1.0, [&]() {
+        solid_count += grid.is_solid(queries[query_index], &penetration_x, &penetration_y);
+        query_index = (query_index + 1) & (QUERY_COUNT - 1);
+    });
+}
+
+static void benchmark_tile_sweep()
+{
+    const int SIZE = 256, QUERY_COUNT = 4096;
+
+    std::vector<unsigned int> level_data = make_level(SIZE, SIZE);
+    TileGrid grid(std::make_shared<MemoryTileSource>(SIZE, SIZE, level_data.data()), 1.0f);
+
+    std::vector<glm::vec3> origins;
+    for (int i = 0; i < QUERY_COUNT; i++)
+    {
+        origins.push_back(glm::vec3(next_random() % (SIZE * 100) / 100.0f, -(next_random() % (SIZE * 100) / 100.0f), 0.0f));
+    }
+
+    int     query_index = 0;
+    TileHit hit;
+    volatile int hit_count = 0;
+
+    // One tick of a fast fall, the longest sweep a step normally makes
+    run("tile_sweep", SIZE * SIZE, 1.0, [&]() {
+        hit_count += grid.sweep(origins[query_index], 0.8f, 0.8f, glm::vec3(0.05f, -0.3f, 0.0f), &hit);
+        query_index = (query_index + 1) & (QUERY_COUNT - 1);
+    });
+}
+
+static void benchmark_grid_build()
+{
+    const int SIZES[][2] = { { 14, 8 }, { 64, 64 }, { 256, 256 }, { 1024, 1024 }, { 4096, 4096 } };
+
+    for (const int *size : SIZES)
+    {
+        std::vector<unsigned int> level_data = make_level(size[0], size[1]);
+        std::shared_ptr<TileSource> source = std::make_shared<MemoryTileSource>(size[0], size[1], level_data.data());
+
+        long long tile_count = (long long) size[0] * size[1];
+        run("tile_grid_build", tile_count, (double) tile_count, [&]() {
+            TileGrid grid(source, 1.0f);
+        });
+    }
+}
+
+static void benchmark_chunk_mesh()
+{
+    const int SIZES[][2] = { { 14, 8 }, { 64, 64 }, { 256, 256 }, { 1024, 1024 }, { 4096, 4096 } };
+
+    for (const int *size : SIZES)
+    {
+        std::vector<unsigned int> level_data = make_level(size[0], size[1]);
+        MemoryTileSource source(size[0], size[1], level_data.data());
+
+        int chunk_count_x = (size[0] + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+        int chunk_count_y = (size[1] + TileGrid::CHUNK_SIZE - 1) / TileGrid::CHUNK_SIZE;
+
+        // Meshing everything once is what a level without a baked cache costs, streamed in over its lifetime
+        long long tile_count = (long long) size[0] * size[1];
+        run("chunk_mesh_all", tile_count, (double) tile_count, [&]() {
+            for (int chunk_y = 0; chunk_y < chunk_count_y; chunk_y++)
+            {
+                for (int chunk_x = 0; chunk_x < chunk_count_x; chunk_x++)
+                {
+                    MapChunk chunk;
+                    chunk.m_chunk_x = chunk_x;
+                    chunk.m_chunk_y = chunk_y;
+
+                    Map::read_chunk_tiles(source, &chunk);
+                    Map::mesh_chunk(&chunk, 4, 1, glm::vec4(0.0f, 0.0f, 1.0f, 1.0f));
+                }
+            }
+        });
+    }
+}
+
+// A floor as wide as the crowd needs, the player at the far left and enemies two tiles apart to the right
+struct BenchmarkWorld
+{
+    std::vector<unsigned int> level_data;
+    std::unique_ptr<TileGrid> grid;
+    World                     world;
+
+    BenchmarkWorld(int enemy_count)
+    {
+        int width  = std::max(32, enemy_count * 2 + 32);
+        int height = 8;
+
+        level_data = make_floor_level(width, height);
+        grid.reset(new TileGrid(std::make_shared<MemoryTileSource>(width, height, level_data.data()), 1.0f));
+
+        world.m_state.map   = NULL;
+        world.m_state.tiles = grid.get();
+
+        world.m_state.player = new Entity(&world.m_entity_pool);
+        world.m_state.player->spawn(LevelSpawn { PLAYER, WALKER, IDLE, 0, 1.0f, -6.0f, 1.75f, 5.0f, 0.0f, -4.81f });
+
+        const AIType AI_TYPES[] = { WALKER, GUARD, JUMPER };
+
+        world.m_state.enemies = new Entity[enemy_count];
+        for (int i = 0; i < enemy_count; i++)
+        {
+            Entity &enemy = world.m_state.enemies[i];
+            enemy.bind(&world.m_entity_pool);
+            enemy.spawn(LevelSpawn { ENEMY, (uint8_t) AI_TYPES[i % 3], (uint8_t) (i % 3 == 1 ? IDLE : WALKING), 0,
+                                     20.0f + i * 2.0f, -6.0f, 1.0f, 2.0f, 0.0f, -4.81f });
+        }
+
+        world.m_state.enemy_count          = enemy_count;
+        world.m_state.defeated_enemy_count = 0;
+        world.m_state.next_scene_id        = -1;
+        world.capture_snapshot();
+    }
+
+    ~BenchmarkWorld()
+    {
+        delete   world.m_state.player;
+        delete[] world.m_state.enemies;
+    }
+};
+
+static void benchmark_world_step()
+{
+    const int ENEMY_COUNTS[] = { 1, 10, 100, 1000, 10000 };
+    const float FIXED_TIMESTEP = 0.0166666f;
+
+    for (int enemy_count : ENEMY_COUNTS)
+    {
+        BenchmarkWorld bench_world(enemy_count);
+
+        // Rewind now and then so the crowd never settles into a state that's cheaper than real play
+        int step_count = 0;
+        run("world_step", enemy_count, enemy_count + 1.0, [&]() {
+            if (++step_count % 600 == 0) bench_world.world.reset();
+            bench_world.world.step(FIXED_TIMESTEP);
+        });
+    }
+}
+
+static void benchmark_overlaps()
+{
+    const int CROWD_SIZES[] = { 10, 100, 1000, 10000 };
+
+    for (int crowd_size : CROWD_SIZES)
+    {
+        // Everyone packed into a square a few tiles across per hundred entities, so most queries find company
+        EntityPool pool;
+        std::vector<Entity> crowd(crowd_size);
+
+        float extent = 4.0f + crowd_size / 25.0f;
+        for (Entity &entity : crowd)
+        {
+            entity.bind(&pool);
+            entity.set_entity_type(ENEMY);
+            entity.set_position(glm::vec3(next_random() % (int) (extent * 100) / 100.0f,
+                                          -(next_random() % (int) (extent * 100) / 100.0f), 0.0f));
+        }
+
+        SpatialHash spatial_hash(2.0f);
+        spatial_hash.insert(crowd.data(), crowd_size);
+        spatial_hash.build();
+
+        int query_index = 0;
+        volatile size_t overlap_count = 0;
+
+        // The per-entity work behind check_collision_x/y against other entities
+        run("entity_overlaps", crowd_size, 1.0, [&]() {
+            overlap_count += spatial_hash.query_overlaps(&crowd[query_index]).size();
+            query_index = (query_index + 1) % crowd_size;
+        });
+
+        run("spatial_hash_build", crowd_size, crowd_size, [&]() {
+            spatial_hash.clear();
+            spatial_hash.insert(crowd.data(), crowd_size);
+            spatial_hash.build();
+        });
+    }
+}
+
+static void benchmark_text_mesh()
+{
+    const int LENGTHS[] = { 8, 32, 256 };
+
+    std::vector<float> vertices;
+    for (int length : LENGTHS)
+    {
+        std::string text;
+        for (int i = 0; i < length; i++) text += (char) ('A' + i % 26);
+
+        run("text_mesh", length, length, [&]() {
+            TextRenderer::mesh_text(text, 0.5f, 0.05f, glm::vec3(1.0f, -2.0f, 0.0f), glm::vec4(0.0f, 0.0f, 1.0f, 1.0f), &vertices);
+        });
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    const char *output_filepath = argc > 1 ? argv[1] : "benchmarks.json";
+    if (argc > 2) g_min_seconds = atof(argv[2]);
+
+    if (!check_entity_kernels()) return 1;
+
+    benchmark_is_solid();
+    benchmark_tile_sweep();
+    benchmark_grid_build();
+    benchmark_chunk_mesh();
+    benchmark_world_step();
+    benchmark_overlaps();
+    benchmark_text_mesh();
+
+    if (!write_json(output_filepath))
+    {
+        LOG("Unable to write " << output_filepath);
+        return 1;
+    }
+
+    LOG("Wrote " << g_results.size() << " results to " << output_filepath);
+    return 0;
+}
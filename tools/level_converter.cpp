@@ -0,0 +1,139 @@
+/**
+    Bakes the level layouts into .plvl files (see LevelFile.h). The arrays below are the source of truth for
+    the shipped levels; edit them here and re-run this tool rather than editing the scenes.
+ 
+    The chunk meshes are baked against the tileset's region of the texture atlas when the output directory
+    has one (see tools/atlas_packer.cpp), so re-run this after re-packing the atlas.
+ 
+    usage: level_converter [output_directory]
+*/
+#define LOG(argument) std::cout << argument << '\n'
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include "../Entity.h"
+#include "../LevelFile.h"
+#include "../TextureAtlas.h"
+
+#define LEVEL_WIDTH 14
+#define LEVEL_HEIGHT 8
+
+// The tileset every level is meshed against: tileset3.png is 4 tiles across, 1 down
+#define TILE_COUNT_X 4
+#define TILE_COUNT_Y 1
+#define TILESET_NAME "tileset3.png"
+
+unsigned int LEVEL0_DATA[] =
+{
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2,
+    3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2
+};
+
+unsigned int LEVEL_DATA[] =
+{
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 1,
+    3, 1, 1, 1, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2,
+    3, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2
+};
+
+unsigned int LEVELB_DATA[] =
+{
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 2,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 2, 2,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 1, 2, 2, 2, 2,
+    3, 1, 1, 1, 1, 1, 1, 0, 1, 2, 2, 2, 2, 2,
+    3, 2, 2, 2, 2, 2, 2, 0, 2, 2, 2, 2, 2, 2
+};
+
+unsigned int LEVELC_DATA[] =
+{
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 1,
+    3, 0, 0, 0, 0, 0, 0, 0, 0, 0, 1, 0, 2, 2,
+    3, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0,
+    3, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0,
+    3, 2, 2, 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0
+};
+
+//                 type    AI      state    -   x      y      speed  jump   accel x  accel y
+LevelSpawn LEVEL0_SPAWNS[] =
+{
+    { PLAYER, WALKER, WALKING, 0, 0.0f,  0.0f,  2.5f,  5.0f,  0.0f,  -9.81f },
+    { ENEMY,  GUARD,  IDLE,    0, 0.0f,  0.0f,  1.0f,  0.0f,  0.0f,  -9.81f },
+};
+
+LevelSpawn LEVEL_SPAWNS[] =
+{
+    { PLAYER, WALKER, WALKING, 0, 3.5f,  5.0f,  2.5f,  5.0f,  0.0f,  -9.81f },
+    { ENEMY,  WALKER, IDLE,    0, 7.0f, -4.98f, 1.0f,  0.0f,  0.0f,   0.0f  },
+};
+
+LevelSpawn LEVELB_SPAWNS[] =
+{
+    { PLAYER, WALKER, WALKING, 0, 3.5f,  5.0f,  1.0f,  5.0f,  0.0f,  -9.81f },
+    { ENEMY,  GUARD,  IDLE,    0, 5.0f, -5.0f,  1.0f,  0.0f,  0.0f,  -9.81f },
+    { ENEMY,  JUMPER, IDLE,    0, 10.0f,-3.0f,  1.0f,  3.0f,  0.0f,  -9.81f },
+};
+
+LevelSpawn LEVELC_SPAWNS[] =
+{
+    { PLAYER, WALKER, WALKING, 0, 3.5f,  5.0f,  1.0f,  5.0f,  0.0f,  -9.81f },
+    { ENEMY,  WALKER, IDLE,    0, 6.0f, -5.0f,  1.0f,  0.0f,  0.0f,  -9.81f },
+    { ENEMY,  GUARD,  IDLE,    0, 4.0f, -5.0f,  1.0f,  2.0f,  0.0f,  -9.81f },
+    { ENEMY,  JUMPER, IDLE,    0, 2.0f, -5.0f,  1.0f,  2.0f,  0.0f,  -9.81f },
+};
+
+glm::vec4 g_tileset_region = glm::vec4(0.0f, 0.0f, 1.0f, 1.0f);
+
+bool convert(const std::string &filepath, unsigned int *level_data, LevelSpawn *spawns, int spawn_count)
+{
+    std::vector<const unsigned int *> layers = { level_data };
+    std::vector<LevelSpawn> spawn_list(spawns, spawns + spawn_count);
+    
+    if (!LevelFile::write(filepath.c_str(), LEVEL_WIDTH, LEVEL_HEIGHT, layers, spawn_list, TILE_COUNT_X, TILE_COUNT_Y,
+                          g_tileset_region))
+    {
+        LOG("Unable to write " << filepath);
+        return false;
+    }
+    
+    LOG("Wrote " << filepath);
+    return true;
+}
+
+int main(int argc, char* argv[])
+{
+    std::string directory = argc > 1 ? std::string(argv[1]) + "/" : "";
+    
+    // Without an atlas the game draws the tileset from its own texture, which is what the default region means
+    TextureAtlas atlas;
+    if (atlas.load((directory + "atlas.txt").c_str()) && atlas.find(TILESET_NAME) != NULL)
+    {
+        g_tileset_region = atlas.get_uv(*atlas.find(TILESET_NAME));
+        LOG("Meshing against " TILESET_NAME " in the atlas");
+    }
+    
+    bool ok = convert(directory + "level0.plvl", LEVEL0_DATA, LEVEL0_SPAWNS, sizeof(LEVEL0_SPAWNS) / sizeof(LevelSpawn)) &&
+              convert(directory + "levelA.plvl", LEVEL_DATA,  LEVEL_SPAWNS,  sizeof(LEVEL_SPAWNS)  / sizeof(LevelSpawn)) &&
+              convert(directory + "levelB.plvl", LEVELB_DATA, LEVELB_SPAWNS, sizeof(LEVELB_SPAWNS) / sizeof(LevelSpawn)) &&
+              convert(directory + "levelC.plvl", LEVELC_DATA, LEVELC_SPAWNS, sizeof(LEVELC_SPAWNS) / sizeof(LevelSpawn));
+    
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,117 @@
+/**
+    Bakes the game's PNGs into .ptex files (see TextureFile.h) next to them, so the game maps and uploads them
+    instead of inflating PNGs at startup. Without options the result samples exactly like the PNG path:
+    RGBA8, no mipmaps, nearest filtering, repeat wrapping.
+
+    --rgba4444  16 bits a texel instead of 32; half the size and upload, at 4 bits a channel
+    --mipmaps   a full mip chain, with the min filter blending between levels. Regions of an atlas page are only
+                padded by TextureAtlas::PADDING texels, so levels below the first couple can blend neighbours.
+    --linear    linear instead of nearest filtering
+    --clamp     clamp to edge instead of repeating
+
+    With no images named, bakes every page in the directory's atlas.txt plus the standalone sheets. Re-run
+    after changing any PNG; a .ptex is used whenever it exists.
+
+    usage: texture_baker <assets directory> [options] [image ...]
+*/
+#define LOG(argument) std::cout << argument << '\n'
+#define STB_IMAGE_IMPLEMENTATION
+
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "stb_image.h"
+#include "../TextureAtlas.h"
+#include "../TextureFile.h"
+
+const char *DEFAULT_IMAGES[] = { "tileset3.png", "player.png", "ghost.png", "font1.png" };
+
+static double milliseconds_since(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        LOG("usage: texture_baker <assets directory> [--rgba4444] [--mipmaps] [--linear] [--clamp] [image ...]");
+        return 1;
+    }
+
+    std::string directory = std::string(argv[1]) + "/";
+
+    TextureFormat format      = TEXTURE_RGBA8;
+    bool          has_mipmaps = false;
+    TextureFilter filter      = FILTER_NEAREST;
+    TextureWrap   wrap        = WRAP_REPEAT;
+
+    std::vector<std::string> names;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if      (strcmp(argv[i], "--rgba4444") == 0) format      = TEXTURE_RGBA4444;
+        else if (strcmp(argv[i], "--mipmaps")  == 0) has_mipmaps = true;
+        else if (strcmp(argv[i], "--linear")   == 0) filter      = FILTER_LINEAR;
+        else if (strcmp(argv[i], "--clamp")    == 0) wrap        = WRAP_CLAMP;
+        else names.push_back(argv[i]);
+    }
+
+    if (names.empty())
+    {
+        TextureAtlas atlas;
+        if (atlas.load((directory + "atlas.txt").c_str()))
+        {
+            for (int page = 0; page < atlas.get_page_count(); page++) names.push_back(atlas.get_page(page).m_filename);
+        }
+
+        names.insert(names.end(), std::begin(DEFAULT_IMAGES), std::end(DEFAULT_IMAGES));
+    }
+
+    for (const std::string &name : names)
+    {
+        std::string filepath       = directory + name;
+        std::string baked_filepath = TextureFile::baked_path(filepath.c_str());
+
+        // Step 1: Decode the PNG the way the game would without a baked file, and time it
+        auto decode_start = std::chrono::steady_clock::now();
+
+        int width, height, number_of_components;
+        unsigned char *pixels = stbi_load(filepath.c_str(), &width, &height, &number_of_components, STBI_rgb_alpha);
+
+        double decode_ms = milliseconds_since(decode_start);
+
+        if (pixels == NULL)
+        {
+            LOG("Unable to load " << filepath);
+            return 1;
+        }
+
+        // Step 2: Bake it
+        bool ok = TextureFile::write(baked_filepath.c_str(), pixels, width, height, format, has_mipmaps, filter, filter,
+                                     wrap, wrap);
+        stbi_image_free(pixels);
+
+        if (!ok)
+        {
+            LOG("Unable to write " << baked_filepath);
+            return 1;
+        }
+
+        // Step 3: Time what the game will do instead, as a check that the file reads back
+        auto open_start = std::chrono::steady_clock::now();
+
+        std::shared_ptr<TextureFile> baked = TextureFile::open(baked_filepath.c_str());
+        if (baked == nullptr) return 1;
+        baked->prefetch();
+
+        double open_ms = milliseconds_since(open_start);
+
+        LOG("Wrote " << baked_filepath << " (" << width << "x" << height << ", " << baked->get_mip_count()
+            << " level(s)): decoding the PNG took " << decode_ms << " ms, mapping the bake " << open_ms << " ms");
+    }
+
+    return 0;
+}